@@ -217,6 +217,18 @@ am_frame_t          am_frame;
 
 static dboolean     isteleportline[NUMLINESPECIALS];
 
+// blocks of lines (map coords), built the first time the automap is drawn in each level
+#define AMBLOCKSHIFT        (7 + MAPBITS)
+
+static int          *amblockoffsets;
+static int          *amblocklines;
+static int          *amlinevalidcount;
+static int          amvalidcount;
+static int          amblockwidth;
+static int          amblockheight;
+static fixed_t      amblockorgx;
+static fixed_t      amblockorgy;
+
 static void AM_Rotate(fixed_t *x, fixed_t *y, angle_t angle);
 static void (*putbigdot)(unsigned int, unsigned int, byte *);
 static void PUTDOT(unsigned int x, unsigned int y, byte *color);
@@ -1484,6 +1496,158 @@ static void AM_DrawGrid(void)
     }
 }
 
+//
+// Sorts the lines in the level into blocks of 128x128 map units, so AM_DrawWalls() only needs
+// to consider those lines in the blocks that intersect the frame. A line is put in every
+// block its bounding box touches. The blocks are allocated with PU_LEVEL, so they are
+// freed, and then built again, whenever a new level is loaded.
+//
+static void AM_InitLineBlocks(void)
+{
+    fixed_t minx = FIXED_MAX;
+    fixed_t miny = FIXED_MAX;
+    fixed_t maxx = FIXED_MIN;
+    fixed_t maxy = FIXED_MIN;
+    int     numblocks;
+    int     *cursor;
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const line_t    *line = &lines[i];
+
+        minx = MIN(minx, line->bbox[BOXLEFT] >> FRACTOMAPBITS);
+        maxx = MAX(maxx, line->bbox[BOXRIGHT] >> FRACTOMAPBITS);
+        miny = MIN(miny, line->bbox[BOXBOTTOM] >> FRACTOMAPBITS);
+        maxy = MAX(maxy, line->bbox[BOXTOP] >> FRACTOMAPBITS);
+    }
+
+    if (!numlines)
+        minx = maxx = miny = maxy = 0;
+
+    amblockorgx = minx;
+    amblockorgy = miny;
+    amblockwidth = ((maxx - minx) >> AMBLOCKSHIFT) + 1;
+    amblockheight = ((maxy - miny) >> AMBLOCKSHIFT) + 1;
+    numblocks = amblockwidth * amblockheight;
+
+    // count the lines in each block
+    Z_Calloc(numblocks + 1, sizeof(*amblockoffsets), PU_LEVEL, (void **)&amblockoffsets);
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const line_t    *line = &lines[i];
+        const int       x1 = ((line->bbox[BOXLEFT] >> FRACTOMAPBITS) - minx) >> AMBLOCKSHIFT;
+        const int       x2 = ((line->bbox[BOXRIGHT] >> FRACTOMAPBITS) - minx) >> AMBLOCKSHIFT;
+        const int       y1 = ((line->bbox[BOXBOTTOM] >> FRACTOMAPBITS) - miny) >> AMBLOCKSHIFT;
+        const int       y2 = ((line->bbox[BOXTOP] >> FRACTOMAPBITS) - miny) >> AMBLOCKSHIFT;
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                amblockoffsets[y * amblockwidth + x + 1]++;
+    }
+
+    for (int i = 1; i <= numblocks; i++)
+        amblockoffsets[i] += amblockoffsets[i - 1];
+
+    // then fill them
+    amblocklines = Z_Malloc(MAX(1, amblockoffsets[numblocks]) * sizeof(*amblocklines), PU_LEVEL, NULL);
+    cursor = Z_Malloc(numblocks * sizeof(*cursor), PU_STATIC, NULL);
+    memcpy(cursor, amblockoffsets, numblocks * sizeof(*cursor));
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const line_t    *line = &lines[i];
+        const int       x1 = ((line->bbox[BOXLEFT] >> FRACTOMAPBITS) - minx) >> AMBLOCKSHIFT;
+        const int       x2 = ((line->bbox[BOXRIGHT] >> FRACTOMAPBITS) - minx) >> AMBLOCKSHIFT;
+        const int       y1 = ((line->bbox[BOXBOTTOM] >> FRACTOMAPBITS) - miny) >> AMBLOCKSHIFT;
+        const int       y2 = ((line->bbox[BOXTOP] >> FRACTOMAPBITS) - miny) >> AMBLOCKSHIFT;
+
+        for (int y = y1; y <= y2; y++)
+            for (int x = x1; x <= x2; x++)
+                amblocklines[cursor[y * amblockwidth + x]++] = i;
+    }
+
+    Z_Free(cursor);
+
+    amlinevalidcount = Z_Calloc(MAX(1, numlines), sizeof(*amlinevalidcount), PU_LEVEL, NULL);
+    amvalidcount = 0;
+}
+
+static void AM_DrawWall(const line_t *line, const dboolean allmap, const dboolean cheating)
+{
+    const unsigned short    flags = line->flags;
+    const sector_t          *back = line->backsector;
+    const dboolean          mapped = flags & ML_MAPPED;
+    const dboolean          secret = flags & ML_SECRET;
+    const unsigned short    special = line->special;
+    mline_t                 mline;
+
+    if ((line->bbox[BOXLEFT] >> FRACTOMAPBITS) > am_frame.bbox[BOXRIGHT]
+        || (line->bbox[BOXRIGHT] >> FRACTOMAPBITS) < am_frame.bbox[BOXLEFT]
+        || (line->bbox[BOXBOTTOM] >> FRACTOMAPBITS) > am_frame.bbox[BOXTOP]
+        || (line->bbox[BOXTOP] >> FRACTOMAPBITS) < am_frame.bbox[BOXBOTTOM])
+        return;
+
+    if ((flags & ML_DONTDRAW) && !cheating)
+        return;
+
+    mline.a.x = line->v1->x >> FRACTOMAPBITS;
+    mline.a.y = line->v1->y >> FRACTOMAPBITS;
+    mline.b.x = line->v2->x >> FRACTOMAPBITS;
+    mline.b.y = line->v2->y >> FRACTOMAPBITS;
+
+    if (am_rotatemode || menuactive)
+    {
+        AM_RotatePoint(&mline.a);
+        AM_RotatePoint(&mline.b);
+    }
+
+    if (special
+        && isteleportline[special]
+        && ((flags & ML_TELEPORTTRIGGERED) || cheating || (back && isteleport[back->floorpic])))
+    {
+        if (cheating || (mapped && !secret && back && back->ceilingheight != back->floorheight))
+        {
+            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, teleportercolor, PUTDOT);
+            return;
+        }
+        else if (allmap)
+        {
+            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapfdwallcolor, PUTDOT);
+            return;
+        }
+    }
+
+    if (!back || (secret && !cheating))
+    {
+        if (mapped || cheating)
+            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, wallcolor, putbigdot);
+        else if (allmap)
+            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapwallcolor, putbigdot);
+    }
+    else
+    {
+        const sector_t  *front = line->frontsector;
+
+        if (back->floorheight != front->floorheight)
+        {
+            if (mapped || cheating)
+                AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, fdwallcolor, PUTDOT);
+            else if (allmap)
+                AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapfdwallcolor, PUTDOT);
+        }
+        else if (back->ceilingheight != front->ceilingheight)
+        {
+            if (mapped || cheating)
+                AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, cdwallcolor, PUTDOT);
+            else if (allmap)
+                AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapcdwallcolor, PUTDOT);
+        }
+        else if (cheating)
+            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, tswallcolor, PUTDOT);
+    }
+}
+
 //
 // Determines visible lines, draws them.
 // This is LineDef based, not LineSeg based.
@@ -1492,89 +1656,37 @@ static void AM_DrawWalls(void)
 {
     const dboolean  allmap = viewplayer->powers[pw_allmap];
     const dboolean  cheating = viewplayer->cheats & (CF_ALLMAP | CF_ALLMAP_THINGS);
-    int             i = 0;
+    int             x1, x2;
+    int             y1, y2;
 
-    while (i < numlines)
-    {
-        const line_t    line = lines[i++];
+    if (!amblockoffsets)
+        AM_InitLineBlocks();
 
-        if ((line.bbox[BOXLEFT] >> FRACTOMAPBITS) > am_frame.bbox[BOXRIGHT]
-            || (line.bbox[BOXRIGHT] >> FRACTOMAPBITS) < am_frame.bbox[BOXLEFT]
-            || (line.bbox[BOXBOTTOM] >> FRACTOMAPBITS) > am_frame.bbox[BOXTOP]
-            || (line.bbox[BOXTOP] >> FRACTOMAPBITS) < am_frame.bbox[BOXBOTTOM])
-            continue;
-        else
+    // am_frame.bbox also bounds the frame when it is rotated
+    x1 = BETWEEN(0, (am_frame.bbox[BOXLEFT] - amblockorgx) >> AMBLOCKSHIFT, amblockwidth - 1);
+    x2 = BETWEEN(0, (am_frame.bbox[BOXRIGHT] - amblockorgx) >> AMBLOCKSHIFT, amblockwidth - 1);
+    y1 = BETWEEN(0, (am_frame.bbox[BOXBOTTOM] - amblockorgy) >> AMBLOCKSHIFT, amblockheight - 1);
+    y2 = BETWEEN(0, (am_frame.bbox[BOXTOP] - amblockorgy) >> AMBLOCKSHIFT, amblockheight - 1);
+
+    // lines in more than one block are only drawn once
+    amvalidcount++;
+
+    for (int y = y1; y <= y2; y++)
+        for (int x = x1; x <= x2; x++)
         {
-            const unsigned short    flags = line.flags;
+            const int   block = y * amblockwidth + x;
 
-            if ((flags & ML_DONTDRAW) && !cheating)
-                continue;
-            else
+            for (int i = amblockoffsets[block]; i < amblockoffsets[block + 1]; i++)
             {
-                const sector_t          *back = line.backsector;
-                const dboolean          mapped = flags & ML_MAPPED;
-                const dboolean          secret = flags & ML_SECRET;
-                const unsigned short    special = line.special;
-                mline_t                 mline;
-
-                mline.a.x = line.v1->x >> FRACTOMAPBITS;
-                mline.a.y = line.v1->y >> FRACTOMAPBITS;
-                mline.b.x = line.v2->x >> FRACTOMAPBITS;
-                mline.b.y = line.v2->y >> FRACTOMAPBITS;
-
-                if (am_rotatemode || menuactive)
-                {
-                    AM_RotatePoint(&mline.a);
-                    AM_RotatePoint(&mline.b);
-                }
-
-                if (special
-                    && isteleportline[special]
-                    && ((flags & ML_TELEPORTTRIGGERED) || cheating || (back && isteleport[back->floorpic])))
-                {
-                    if (cheating || (mapped && !secret && back && back->ceilingheight != back->floorheight))
-                    {
-                        AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, teleportercolor, PUTDOT);
-                        continue;
-                    }
-                    else if (allmap)
-                    {
-                        AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapfdwallcolor, PUTDOT);
-                        continue;
-                    }
-                }
+                const int   linenum = amblocklines[i];
 
-                if (!back || (secret && !cheating))
+                if (amlinevalidcount[linenum] != amvalidcount)
                 {
-                    if (mapped || cheating)
-                        AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, wallcolor, putbigdot);
-                    else if (allmap)
-                        AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapwallcolor, putbigdot);
-                }
-                else
-                {
-                    const sector_t  *front = line.frontsector;
-
-                    if (back->floorheight != front->floorheight)
-                    {
-                        if (mapped || cheating)
-                            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, fdwallcolor, PUTDOT);
-                        else if (allmap)
-                            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapfdwallcolor, PUTDOT);
-                    }
-                    else if (back->ceilingheight != front->ceilingheight)
-                    {
-                        if (mapped || cheating)
-                            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, cdwallcolor, PUTDOT);
-                        else if (allmap)
-                            AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, allmapcdwallcolor, PUTDOT);
-                    }
-                    else if (cheating)
-                        AM_DrawFline(mline.a.x, mline.a.y, mline.b.x, mline.b.y, tswallcolor, PUTDOT);
+                    amlinevalidcount[linenum] = amvalidcount;
+                    AM_DrawWall(&lines[linenum], allmap, cheating);
                 }
             }
         }
-    }
 }
 
 static void AM_DrawLineCharacter(const mline_t *lineguy, const int lineguylines,
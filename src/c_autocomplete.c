@@ -6620,11 +6620,13 @@ autocomplete_t autocompletelist[] =
     { "if r_skycolor white then ",                   DOOM1AND2 },
     { "if r_skycolor yellow ",                       DOOM1AND2 },
     { "if r_skycolor yellow then ",                  DOOM1AND2 },
+    { "if r_texturecache ",                          DOOM1AND2 },
     { "if r_textures ",                              DOOM1AND2 },
     { "if r_textures off ",                          DOOM1AND2 },
     { "if r_textures off then ",                     DOOM1AND2 },
     { "if r_textures on ",                           DOOM1AND2 },
     { "if r_textures on then ",                      DOOM1AND2 },
+    { "if r_threads ",                               DOOM1AND2 },
     { "if r_translucency ",                          DOOM1AND2 },
     { "if r_translucency off ",                      DOOM1AND2 },
     { "if r_translucency off then ",                 DOOM1AND2 },
@@ -6673,6 +6675,11 @@ autocomplete_t autocompletelist[] =
     { "if s_stereo off then ",                       DOOM1AND2 },
     { "if s_stereo on ",                             DOOM1AND2 },
     { "if s_stereo on then ",                        DOOM1AND2 },
+    { "if savecompression ",                         DOOM1AND2 },
+    { "if savecompression off ",                     DOOM1AND2 },
+    { "if savecompression off then ",                DOOM1AND2 },
+    { "if savecompression on ",                      DOOM1AND2 },
+    { "if savecompression on then ",                 DOOM1AND2 },
     { "if savegame ",                                DOOM1AND2 },
     { "if skilllevel ",                              DOOM1AND2 },
     { "if stillbob ",                                DOOM1AND2 },
@@ -6734,6 +6741,11 @@ autocomplete_t autocompletelist[] =
     { "if vid_pillarboxes off then ",                DOOM1AND2 },
     { "if vid_pillarboxes on ",                      DOOM1AND2 },
     { "if vid_pillarboxes on then ",                 DOOM1AND2 },
+    { "if vid_pipeline ",                            DOOM1AND2 },
+    { "if vid_pipeline off ",                        DOOM1AND2 },
+    { "if vid_pipeline off then ",                   DOOM1AND2 },
+    { "if vid_pipeline on ",                         DOOM1AND2 },
+    { "if vid_pipeline on then ",                    DOOM1AND2 },
     { "if vid_scaleapi ",                            DOOM1AND2 },
 #if defined(_WIN32)
     { "if vid_scaleapi \"direct3d\" ",               DOOM1AND2 },
@@ -7176,6 +7188,7 @@ autocomplete_t autocompletelist[] =
     { "+mark",                                       DOOM1AND2 },
     { "+maxzoom",                                    DOOM1AND2 },
     { "+menu",                                       DOOM1AND2 },
+    { "memory",                                      DOOM1AND2 },
     { "messages ",                                   DOOM1AND2 },
     { "messages off",                                DOOM1AND2 },
     { "messages on",                                 DOOM1AND2 },
@@ -7439,6 +7452,9 @@ autocomplete_t autocompletelist[] =
     { "playerstats",                                 DOOM1AND2 },
     { "+prevweapon",                                 DOOM1AND2 },
     { "print ",                                      DOOM1AND2 },
+    { "profile",                                     DOOM1AND2 },
+    { "profile off",                                 DOOM1AND2 },
+    { "profile on",                                  DOOM1AND2 },
     { "quit",                                        DOOM1AND2 },
     { "r_althud ",                                   DOOM1AND2 },
     { "r_althud off",                                DOOM1AND2 },
@@ -7608,9 +7624,11 @@ autocomplete_t autocompletelist[] =
     { "r_skycolor tan",                              DOOM1AND2 },
     { "r_skycolor white",                            DOOM1AND2 },
     { "r_skycolor yellow",                           DOOM1AND2 },
+    { "r_texturecache ",                             DOOM1AND2 },
     { "r_textures ",                                 DOOM1AND2 },
     { "r_textures off",                              DOOM1AND2 },
     { "r_textures on",                               DOOM1AND2 },
+    { "r_threads ",                                  DOOM1AND2 },
     { "r_translucency ",                             DOOM1AND2 },
     { "r_translucency off",                          DOOM1AND2 },
     { "r_translucency on",                           DOOM1AND2 },
@@ -7717,7 +7735,9 @@ autocomplete_t autocompletelist[] =
     { "reset r_shake_barrels",                       DOOM1AND2 },
     { "reset r_shake_damage",                        DOOM1AND2 },
     { "reset r_skycolor",                            DOOM1AND2 },
+    { "reset r_texturecache",                        DOOM1AND2 },
     { "reset r_textures",                            DOOM1AND2 },
+    { "reset r_threads",                             DOOM1AND2 },
     { "reset r_translucency",                        DOOM1AND2 },
     { "reset s_channels",                            DOOM1AND2 },
     { "reset s_musicvolume",                         DOOM1AND2 },
@@ -7725,6 +7745,7 @@ autocomplete_t autocompletelist[] =
     { "reset s_randompitch",                         DOOM1AND2 },
     { "reset s_sfxvolume",                           DOOM1AND2 },
     { "reset s_stereo",                              DOOM1AND2 },
+    { "reset savecompression",                       DOOM1AND2 },
     { "reset savegame",                              DOOM1AND2 },
     { "reset skilllevel",                            DOOM1AND2 },
     { "reset stillbob",                              DOOM1AND2 },
@@ -7740,6 +7761,7 @@ autocomplete_t autocompletelist[] =
     { "reset vid_fullscreen",                        DOOM1AND2 },
     { "reset vid_motionblur",                        DOOM1AND2 },
     { "reset vid_pillarboxes",                       DOOM1AND2 },
+    { "reset vid_pipeline",                          DOOM1AND2 },
     { "reset vid_scaleapi",                          DOOM1AND2 },
     { "reset vid_scalefilter",                       DOOM1AND2 },
     { "reset vid_screenresolution",                  DOOM1AND2 },
@@ -7804,6 +7826,9 @@ autocomplete_t autocompletelist[] =
     { "s_stereo off",                                DOOM1AND2 },
     { "s_stereo on",                                 DOOM1AND2 },
     { "save ",                                       DOOM1AND2 },
+    { "savecompression ",                            DOOM1AND2 },
+    { "savecompression off",                         DOOM1AND2 },
+    { "savecompression on",                          DOOM1AND2 },
     { "savegame ",                                   DOOM1AND2 },
     { "+screenshot",                                 DOOM1AND2 },
     { "skilllevel ",                                 DOOM1AND2 },
@@ -8169,6 +8194,9 @@ autocomplete_t autocompletelist[] =
     { "vid_pillarboxes ",                            DOOM1AND2 },
     { "vid_pillarboxes off",                         DOOM1AND2 },
     { "vid_pillarboxes on",                          DOOM1AND2 },
+    { "vid_pipeline ",                               DOOM1AND2 },
+    { "vid_pipeline off",                            DOOM1AND2 },
+    { "vid_pipeline on",                             DOOM1AND2 },
     { "vid_scaleapi ",                               DOOM1AND2 },
 #if defined(_WIN32)
     { "vid_scaleapi \"direct3d\"",                   DOOM1AND2 },
@@ -88,6 +88,7 @@
 #define PLAYCMDFORMAT               "<i>soundeffect</i>|<i>music</i>"
 #define NAMECMDFORMAT               "[<b>friendly</b> ]<i>monster</i> <i>name</i>"
 #define PRINTCMDFORMAT              "<b>\"</b><i>message</i><b>\"</b>"
+#define PROFILECMDFORMAT            "[<b>on</b>|<b>off</b>|<i>filename</i><b>.csv</b>]"
 #define RESETCMDFORMAT              "<i>CVAR</i>"
 #define RESURRECTCMDFORMAT          "<b>player</b>|<b>all</b>|<i>monster</i>"
 #define SAVECMDFORMAT               LOADCMDFORMAT
@@ -296,6 +297,7 @@ static dboolean map_cmd_func1(char *cmd, char *parms);
 static void map_cmd_func2(char *cmd, char *parms);
 static void maplist_cmd_func2(char *cmd, char *parms);
 static void mapstats_cmd_func2(char *cmd, char *parms);
+static void memory_cmd_func2(char *cmd, char *parms);
 static dboolean name_cmd_func1(char *cmd, char *parms);
 static void name_cmd_func2(char *cmd, char *parms);
 static void newgame_cmd_func2(char *cmd, char *parms);
@@ -307,6 +309,7 @@ static dboolean play_cmd_func1(char *cmd, char *parms);
 static void play_cmd_func2(char *cmd, char *parms);
 static void playerstats_cmd_func2(char *cmd, char *parms);
 static void print_cmd_func2(char *cmd, char *parms);
+static void profile_cmd_func2(char *cmd, char *parms);
 static void quit_cmd_func2(char *cmd, char *parms);
 static void regenhealth_cmd_func2(char *cmd, char *parms);
 static void reset_cmd_func2(char *cmd, char *parms);
@@ -622,6 +625,8 @@ consolecmd_t consolecmds[] =
         "Lists all maps in the currently loaded WADs."),
     CMD(mapstats, "", game_func1, mapstats_cmd_func2, false, "",
         "Shows stats about the current map."),
+    CMD(memory, "", null_func1, memory_cmd_func2, false, "",
+        "Shows stats about the memory allocated."),
     CVAR_BOOL(messages, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
         "Toggles player messages."),
     CVAR_BOOL(mouselook, "", bool_cvars_func1, mouselook_cvar_func2, BOOLVALUEALIAS,
@@ -649,6 +654,8 @@ consolecmd_t consolecmds[] =
         "Shows stats about the player."),
     CMD(print, "", null_func1, print_cmd_func2, true, PRINTCMDFORMAT,
         "Prints a player <b>\"</b><i>message</i><b>\"</b>."),
+    CMD(profile, "", null_func1, profile_cmd_func2, true, PROFILECMDFORMAT,
+        "Toggles showing the time taken by each stage of\nthe last few frames, or writes the time taken by\neach frame to a <i>filename</i><b>.csv</b>."),
     CMD(quit, exit, null_func1, quit_cmd_func2, false, "",
         "Quits <i><b>" PACKAGE_NAME ".</b></i>"),
     CVAR_BOOL(r_althud, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
@@ -733,8 +740,12 @@ consolecmd_t consolecmds[] =
         "The amount the screen shakes when the player is\nattacked (<b>0%</b> to <b>100%</b>)."),
     CVAR_INT(r_skycolor, r_skycolour, r_skycolor_cvar_func1, r_skycolor_cvar_func2, CF_NONE, SKYVALUEALIAS,
         "The color of the sky (<b>none</b>, or <b>0</b> to <b>255</b>)."),
+    CVAR_INT(r_texturecache, "", int_cvars_func1, int_cvars_func2, CF_NONE, NOVALUEALIAS,
+        "The amount of memory in megabytes used to cache\nwall textures (<b>16</b> to <b>4096</b>)."),
     CVAR_BOOL(r_textures, "", bool_cvars_func1, r_textures_cvar_func2, BOOLVALUEALIAS,
         "Toggles displaying all textures."),
+    CVAR_INT(r_threads, "", int_cvars_func1, int_cvars_func2, CF_NONE, NOVALUEALIAS,
+        "The number of threads used to render the player's\nview (<b>1</b> to <b>8</b>)."),
     CVAR_BOOL(r_translucency, "", bool_cvars_func1, r_translucency_cvar_func2, BOOLVALUEALIAS,
         "Toggles the translucency of sprites and <i><b>BOOM</b></i>-\ncompatible wall textures."),
     CMD(regenhealth, "", null_func1, regenhealth_cmd_func2, true, "[<b>on</b>|<b>off</b>]",
@@ -765,6 +776,8 @@ consolecmd_t consolecmds[] =
         "Toggles playing sound effects in mono or stereo."),
     CMD(save, "", alive_func1, save_cmd_func2, true, SAVECMDFORMAT,
         "Saves the game to a file."),
+    CVAR_BOOL(savecompression, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles compressing savegames."),
     CVAR_INT(savegame, "", int_cvars_func1, savegame_cvar_func2, CF_NONE, NOVALUEALIAS,
         "The currently selected savegame in the menu\n(<b>1</b> to <b>6</b>)."),
     CVAR_INT(skilllevel, "", int_cvars_func1, skilllevel_cvar_func2, CF_NONE, NOVALUEALIAS,
@@ -811,6 +824,8 @@ consolecmd_t consolecmds[] =
         "The amount of motion blur when the player turns\nquickly (<b>0%</b> to <b>100%</b>)."),
     CVAR_BOOL(vid_pillarboxes, "", bool_cvars_func1, vid_pillarboxes_cvar_func2, BOOLVALUEALIAS,
         "Toggles using the black pillarboxes either side of\nthe screen for palette effects."),
+    CVAR_BOOL(vid_pipeline, "", bool_cvars_func1, bool_cvars_func2, BOOLVALUEALIAS,
+        "Toggles running the game while each frame is\nbeing shown."),
 #if defined(_WIN32)
     CVAR_STR(vid_scaleapi, "", vid_scaleapi_cvar_func1, vid_scaleapi_cvar_func2, CF_NONE,
         "The API used to scale each frame (<b>\"direct3d\"</b>,\n<b>\"opengl\"</b> or <b>\"software\"</b>)."),
@@ -3721,7 +3736,8 @@ static void mapstats_cmd_func2(char *cmd, char *parms)
     free(temp);
 
     C_TabbedOutput(tabs, "Node format\t<b>%s</b>",
-        (mapformat == DOOMBSP ? "Regular" : (mapformat == DEEPBSP ? "<i>DeePBSP v4</i>" : "<i>ZDoom</i> (uncompressed)")));
+        (mapformat == DOOMBSP ? "Regular" : (mapformat == DEEPBSP ? "<i>DeePBSP v4</i>" :
+        (mapformat == ZDBSPX ? "<i>ZDoom</i> (uncompressed)" : "Built by <i>" PACKAGE_NAME "</i>"))));
 
     temp = commify(numsectors);
     C_TabbedOutput(tabs, "Sectors\t<b>%s</b>", temp);
@@ -3889,6 +3905,47 @@ static void mapstats_cmd_func2(char *cmd, char *parms)
     }
 }
 
+//
+// memory CCMD
+//
+static void memory_cmd_func2(char *cmd, char *parms)
+{
+    const int   tabs[8] = { 80, 160, 240, 0, 0, 0, 0, 0 };
+    const char  *tagnames[PU_MAX] = { "", "Static", "Level", "Specials", "Cache" };
+    int         totalcount = 0;
+    size_t      totalbytes = 0;
+    char        *temp1;
+    char        *temp2;
+    char        *temp3;
+
+    C_TabbedOutput(tabs, "<b>Tag</b>\t<b>Blocks</b>\t<b>Bytes</b>\t<b>Reserved</b>");
+
+    for (int i = PU_STATIC; i < PU_MAX; i++)
+    {
+        int     count;
+        size_t  bytes;
+        size_t  reserved;
+
+        Z_GetTagStats(i, &count, &bytes, &reserved);
+        temp1 = commify(count);
+        temp2 = commify(bytes);
+        temp3 = commify(reserved);
+        C_TabbedOutput(tabs, "%s\t%s\t%s\t%s", tagnames[i], temp1, temp2, (reserved ? temp3 : "-"));
+        free(temp1);
+        free(temp2);
+        free(temp3);
+
+        totalcount += count;
+        totalbytes += bytes;
+    }
+
+    temp1 = commify(totalcount);
+    temp2 = commify(totalbytes);
+    C_TabbedOutput(tabs, "<b>Total</b>\t<b>%s</b>\t<b>%s</b>", temp1, temp2);
+    free(temp1);
+    free(temp2);
+}
+
 //
 // name CCMD
 //
@@ -5051,6 +5108,42 @@ static void print_cmd_func2(char *cmd, char *parms)
     }
 }
 
+//
+// profile CCMD
+//
+static void profile_cmd_func2(char *cmd, char *parms)
+{
+    if (*parms)
+    {
+        const int   value = C_LookupValueFromAlias(parms, BOOLVALUEALIAS);
+
+        if (value == 0)
+            profiling = false;
+        else if (value == 1)
+            profiling = true;
+        else
+        {
+            char    *filename = M_StringJoin(parms, (M_StringEndsWith(parms, ".csv") ? "" : ".csv"), NULL);
+
+            if (!I_StartProfileCSV(filename))
+                C_Warning(0, "<b>%s</b> couldn't be opened.", filename);
+            else
+            {
+                C_Output("The time taken by each frame is now being written to <b>%s</b>.", filename);
+                profiling = true;
+            }
+
+            free(filename);
+            return;
+        }
+    }
+    else
+        profiling = !profiling;
+
+    if (!profiling)
+        I_StopProfileCSV();
+}
+
 //
 // quit CCMD
 //
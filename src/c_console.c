@@ -56,6 +56,7 @@
 #include "m_menu.h"
 #include "m_misc.h"
 #include "r_main.h"
+#include "r_things.h"
 #include "s_sound.h"
 #include "st_stuff.h"
 #include "v_video.h"
@@ -766,46 +767,23 @@ void C_HideConsoleFast(void)
 static void C_DrawBackground(int height)
 {
     static dboolean blurred;
+    static byte     sourcescreen[SCREENWIDTH * SCREENHEIGHT];
     static byte     blurscreen[SCREENWIDTH * SCREENHEIGHT];
+    static byte     tintscreen[SCREENWIDTH * SCREENHEIGHT];
+    static int      blurheight;
+    static int      tintcolor = -1;
+    const int       color = nearestcolors[con_backcolor] << 8;
+    const int       fullheight = (MAX(CONSOLEHEIGHT, height) + 5) * CONSOLEWIDTH;
 
     height = (height + 5) * CONSOLEWIDTH;
 
-    if (!blurred)
+    // blur the background behind the entire console, but only when it has changed
+    if (!blurred && (blurheight != fullheight || memcmp(sourcescreen, screens[0], fullheight)))
     {
-        // blur background
-        memcpy(blurscreen, screens[0], height);
-
-        for (int y = 0; y <= height - CONSOLEWIDTH; y += CONSOLEWIDTH)
-            for (int x = y; x <= y + CONSOLEWIDTH - 2; x++)
-                blurscreen[x] = tinttab50[(blurscreen[x + 1] << 8) + blurscreen[x]];
-
-        for (int y = 0; y <= height - CONSOLEWIDTH; y += CONSOLEWIDTH)
-            for (int x = y + CONSOLEWIDTH - 2; x >= y; x--)
-                blurscreen[x] = tinttab50[(blurscreen[x - 1] << 8) + blurscreen[x]];
-
-        for (int y = 0; y <= height - CONSOLEWIDTH * 2; y += CONSOLEWIDTH)
-            for (int x = y; x <= y + CONSOLEWIDTH - 2; x++)
-                blurscreen[x] = tinttab50[(blurscreen[x + CONSOLEWIDTH + 1] << 8) + blurscreen[x]];
-
-        for (int y = height - CONSOLEWIDTH; y >= CONSOLEWIDTH; y -= CONSOLEWIDTH)
-            for (int x = y + CONSOLEWIDTH - 1; x >= y + 1; x--)
-                blurscreen[x] = tinttab50[(blurscreen[x - CONSOLEWIDTH - 1] << 8) + blurscreen[x]];
-
-        for (int y = 0; y <= height - CONSOLEWIDTH * 2; y += CONSOLEWIDTH)
-            for (int x = y; x <= y + CONSOLEWIDTH - 1; x++)
-                blurscreen[x] = tinttab50[(blurscreen[x + CONSOLEWIDTH] << 8) + blurscreen[x]];
-
-        for (int y = height - CONSOLEWIDTH; y >= CONSOLEWIDTH; y -= CONSOLEWIDTH)
-            for (int x = y; x <= y + CONSOLEWIDTH - 1; x++)
-                blurscreen[x] = tinttab50[(blurscreen[x - CONSOLEWIDTH] << 8) + blurscreen[x]];
-
-        for (int y = 0; y <= height - CONSOLEWIDTH * 2; y += CONSOLEWIDTH)
-            for (int x = y + CONSOLEWIDTH - 1; x >= y + 1; x--)
-                blurscreen[x] = tinttab50[(blurscreen[x + CONSOLEWIDTH - 1] << 8) + blurscreen[x]];
-
-        for (int y = height - CONSOLEWIDTH; y >= CONSOLEWIDTH; y -= CONSOLEWIDTH)
-            for (int x = y; x <= y + CONSOLEWIDTH - 2; x++)
-                blurscreen[x] = tinttab50[(blurscreen[x - CONSOLEWIDTH + 1] << 8) + blurscreen[x]];
+        memcpy(sourcescreen, screens[0], fullheight);
+        V_BlurScreen(sourcescreen, blurscreen, fullheight);
+        blurheight = fullheight;
+        tintcolor = -1;
     }
 
     if (forceconsoleblurredraw)
@@ -816,13 +794,20 @@ static void C_DrawBackground(int height)
     else
         blurred = (consoleheight == CONSOLEHEIGHT && !dowipe);
 
-    // tint background using con_backcolor CVAR
-    for (int i = 0, color = nearestcolors[con_backcolor] << 8; i < height; i++)
-        screens[0][i] = tinttab50[blurscreen[i] + color];
+    if (tintcolor != color)
+    {
+        // tint background using con_backcolor CVAR
+        for (int i = 0; i < fullheight; i++)
+            tintscreen[i] = tinttab50[blurscreen[i] + color];
+
+        // apply corrugated glass effect to background
+        for (int i = fullheight - 2; i > 1; i -= 3)
+            tintscreen[i + 1] = colormaps[0][6 * 256 + tintscreen[i + (i % CONSOLEWIDTH && (i + 1) % CONSOLEWIDTH ? -1 : 1)]];
+
+        tintcolor = color;
+    }
 
-    // apply corrugated glass effect to background
-    for (int i = height - 2; i > 1; i -= 3)
-        screens[0][i + 1] = colormaps[0][6 * 256 + screens[0][i + (i % CONSOLEWIDTH && (i + 1) % CONSOLEWIDTH ? -1 : 1)]];
+    memcpy(screens[0], tintscreen, height);
 
     // draw branding
     V_DrawBigTranslucentPatch(CONSOLEWIDTH - brandwidth, consoleheight - brandheight + 2, brand);
@@ -1112,6 +1097,46 @@ void C_UpdateFPS(void)
     }
 }
 
+//
+// C_UpdateProfile
+// Show the average and worst times spent in each stage of the last few frames in the top
+// right of the screen, below the FPS if that is shown, followed by the average, jitter and worst
+// time between frames, and how many drawsegs each sprite was checked against in the last frame.
+//
+void C_UpdateProfile(void)
+{
+    if (!dowipe && !menuactive)
+    {
+        int     y = CONSOLETEXTY + (vid_showfps ? CONSOLELINEHEIGHT : 0);
+        char    buffer[64];
+        double  average;
+        double  jitter;
+        double  worst;
+
+        for (int i = 0; i < NUMPROFILESTAGES; i++, y += CONSOLELINEHEIGHT)
+        {
+            I_GetProfile(i, &average, &worst);
+            M_snprintf(buffer, sizeof(buffer), "%s %.2fms (%.2fms)", profilestagenames[i], average, worst);
+            C_DrawOverlayText(CONSOLEWIDTH - C_TextWidth(buffer, false, false) - CONSOLETEXTX + 1, y, buffer,
+                (worst >= 1000.0 / TICRATE ? consolelowfpscolor : consolehighfpscolor), false);
+        }
+
+        I_GetFramePacing(&average, &jitter, &worst);
+        M_snprintf(buffer, sizeof(buffer), "Frames %.2fms (jitter %.2fms, worst %.2fms)", average, jitter, worst);
+        C_DrawOverlayText(CONSOLEWIDTH - C_TextWidth(buffer, false, false) - CONSOLETEXTX + 1, y, buffer,
+            (worst >= 1000.0 / TICRATE ? consolelowfpscolor : consolehighfpscolor), false);
+        y += CONSOLELINEHEIGHT;
+
+        if (gamestate == GS_LEVEL)
+        {
+            M_snprintf(buffer, sizeof(buffer), "Sprites %i (%.1f drawsegs each)", spritesclipped,
+                (spritesclipped ? (double)clipsegsvisited / spritesclipped : 0.0));
+            C_DrawOverlayText(CONSOLEWIDTH - C_TextWidth(buffer, false, false) - CONSOLETEXTX + 1, y, buffer,
+                consolehighfpscolor, false);
+        }
+    }
+}
+
 void C_UpdateTimer(void)
 {
     if (!paused && !menuactive)
@@ -197,6 +197,7 @@ void C_PrintCompileDate(void);
 void C_PrintSDLVersions(void);
 void C_UpdateFPS(void);
 void C_UpdateTimer(void);
+void C_UpdateProfile(void);
 char *C_GetTimeStamp(unsigned int tics);
 
 #endif
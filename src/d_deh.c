@@ -2118,7 +2118,7 @@ void ProcessDehFile(char *filename, int lumpnum)
     }
 
     if (infile.lump)
-        Z_ChangeTag(infile.lump, PU_CACHE);                     // mark purgeable
+        W_ReleaseLumpNum(lumpnum);                              // mark purgeable
     else
         fclose(infile.f);                                       // close real file
 
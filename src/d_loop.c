@@ -36,23 +36,27 @@
 ========================================================================
 */
 
+#include "SDL.h"
+
 #include "d_main.h"
 #include "doomstat.h"
 #include "g_game.h"
 #include "i_system.h"
 #include "i_timer.h"
+#include "m_config.h"
 #include "m_menu.h"
 
 ticcmd_t        localcmds[BACKUPTICS];
 
 extern dboolean advancetitle;
 
-void TryRunTics(void)
+static int      maketic;
+
+// Build the ticcmds for any tics that are now due, and return how many tics are ready to run
+static int D_MakeTics(void)
 {
-    static int  maketic;
     static int  lastmadetic;
     int         newtics = I_GetTime() - lastmadetic;
-    int         runtics;
 
     lastmadetic += newtics;
 
@@ -66,21 +70,103 @@ void TryRunTics(void)
         G_BuildTiccmd(&localcmds[maketic++ % BACKUPTICS]);
     }
 
-    if (!(runtics = maketic - gametime) && vid_capfps != TICRATE)
+    return (maketic - gametime);
+}
+
+static void D_RunTic(void)
+{
+    if (advancetitle)
+        D_DoAdvanceTitle();
+
+    if (menuactive)
+        M_Ticker();
+
+    G_Ticker();
+    gametime++;
+
+    if (localcmds[0].buttons & BT_SPECIAL)
+        localcmds[0].buttons = 0;
+}
+
+void TryRunTics(void)
+{
+    int runtics;
+
+    if (!(runtics = D_MakeTics()) && vid_capfps != TICRATE)
         return;
 
     while (runtics--)
+        D_RunTic();
+}
+
+//
+// Pipelining
+// When vid_pipeline is on, D_StartTics() is called once a frame has been drawn, and runs the
+// tics that are due by then on another thread while the frame is blitted, presented and paced.
+// D_FinishTics() waits for them before sounds are updated and the next frame is drawn, so the
+// renderer never runs at the same time as the game. Only tics in a level that won't pause, save
+// or load anything are run this way, since those need the main thread, and the thread stops if
+// a tic starts one. Any tics it doesn't run are run by TryRunTics() as usual.
+//
+dboolean        vid_pipeline = vid_pipeline_default;
+
+static SDL_Thread   *ticthread;
+static SDL_sem      *ticthreadstart;
+static SDL_sem      *ticthreaddone;
+static int          ticthreadtics;
+static dboolean     ticthreadrunning;
+
+static dboolean D_CanRunTicsOnThread(void)
+{
+    return (gamestate == GS_LEVEL && gameaction == ga_nothing && !menuactive && !advancetitle
+        && !paused && !demoplayback && !demorecording);
+}
+
+static int SDLCALL D_TicThread(void *data)
+{
+    while (true)
+    {
+        SDL_SemWait(ticthreadstart);
+
+        while (ticthreadtics-- > 0 && D_CanRunTicsOnThread())
+            D_RunTic();
+
+        SDL_SemPost(ticthreaddone);
+    }
+
+    return 0;
+}
+
+void D_StartTics(void)
+{
+    if (!vid_pipeline || !D_CanRunTicsOnThread() || !(ticthreadtics = D_MakeTics()) || !D_CanRunTicsOnThread())
+        return;
+
+    for (int i = gametime; i < maketic; i++)
+        if (localcmds[i % BACKUPTICS].buttons & BT_SPECIAL)
+            return;
+
+    if (!ticthread)
     {
-        if (advancetitle)
-            D_DoAdvanceTitle();
+        if (!ticthreadstart && !(ticthreadstart = SDL_CreateSemaphore(0)))
+            return;
 
-        if (menuactive)
-            M_Ticker();
+        if (!ticthreaddone && !(ticthreaddone = SDL_CreateSemaphore(0)))
+            return;
 
-        G_Ticker();
-        gametime++;
+        if (!(ticthread = SDL_CreateThread(&D_TicThread, "D_TicThread", NULL)))
+            return;
+    }
 
-        if (localcmds[0].buttons & BT_SPECIAL)
-            localcmds[0].buttons = 0;
+    ticthreadrunning = true;
+    SDL_SemPost(ticthreadstart);
+}
+
+void D_FinishTics(void)
+{
+    if (ticthreadrunning)
+    {
+        SDL_SemWait(ticthreaddone);
+        ticthreadrunning = false;
     }
 }
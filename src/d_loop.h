@@ -45,4 +45,7 @@
 // how many ticks to run?
 void TryRunTics(void);
 
+void D_StartTics(void);
+void D_FinishTics(void);
+
 #endif
@@ -94,6 +94,8 @@
 #import <Cocoa/Cocoa.h>
 #endif
 
+#define BENCHMARKTICS   (60 * TICRATE)
+
 char **episodes[] =
 {
     &s_M_EPISODE1,
@@ -152,6 +154,7 @@ static char         dehwarning[256] = "";
 char                *previouswad;
 #endif
 
+dboolean            benchmark;              // checkparm of -benchmark
 dboolean            devparm;                // started game with -devparm
 dboolean            fastparm;               // checkparm of -fast
 dboolean            freeze;
@@ -176,6 +179,8 @@ dboolean            splashscreen = true;
 
 static int          startuptimer;
 
+static int          benchmarktics = BENCHMARKTICS;
+
 dboolean            realframe;
 static dboolean     error;
 
@@ -184,10 +189,6 @@ struct tm           gamestarttime;
 extern int          countdown;
 extern evtype_t     lasteventtype;
 
-#if defined(_WIN32)
-extern HANDLE       CapFPSEvent;
-#endif
-
 //
 // D_PostEvent
 //
@@ -235,6 +236,8 @@ void D_Display(void)
     if (vid_capfps != TICRATE && (realframe = (gametime > saved_gametime)))
         saved_gametime = gametime;
 
+    I_UpdateMapWindow();
+
     // change the view size if needed
     if (setsizeneeded)
     {
@@ -290,10 +293,12 @@ void D_Display(void)
         if (am_path && !(viewplayer->cheats & CF_NOCLIP) && !freeze)
             AM_AddToPath();
 
-        if (mapwindow || automapactive)
+        if (automapactive || (mapwindow && drawmapwindow))
             AM_Drawer();
 
+        I_StartProfile(PROFILE_HUD);
         ST_Drawer((viewheight == SCREENHEIGHT), true);
+        I_EndProfile(PROFILE_HUD);
 
         // see if the border needs to be initially drawn
         if (oldgamestate != GS_LEVEL)
@@ -307,7 +312,7 @@ void D_Display(void)
         {
             if (scaledviewwidth != SCREENWIDTH)
             {
-                if (menuactive || menuactivestate || !viewactivestate || vid_showfps || countdown || paused
+                if (menuactive || menuactivestate || !viewactivestate || vid_showfps || profiling || countdown || paused
                     || pausedstate || message_on || consoleheight > CONSOLETOP)
                     borderdrawcount = 3;
 
@@ -322,7 +327,9 @@ void D_Display(void)
                 V_LowGraphicDetail();
         }
 
+        I_StartProfile(PROFILE_HUD);
         HU_Drawer();
+        I_EndProfile(PROFILE_HUD);
     }
 
     menuactivestate = menuactive;
@@ -359,7 +366,9 @@ void D_Display(void)
 
     if (!dowipe || !wipe)
     {
+        I_StartProfile(PROFILE_CONSOLE);
         C_Drawer();
+        I_EndProfile(PROFILE_CONSOLE);
 
         // menus go directly to the screen
         M_Drawer();
@@ -370,18 +379,28 @@ void D_Display(void)
         if (countdown && gamestate == GS_LEVEL)
             C_UpdateTimer();
 
+        if (profiling)
+            C_UpdateProfile();
+
+        // run the next tics while the frame is shown
+        D_StartTics();
+
         // normal update
+        I_StartProfile(PROFILE_BLIT);
         blitfunc();             // blit buffer
-        mapblitfunc();
+        I_EndProfile(PROFILE_BLIT);
 
-#if defined(_WIN32)
-        if (CapFPSEvent)
-            WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+        if (drawmapwindow)
+            mapblitfunc();
+
+        I_WaitForFrame();
+
+        D_FinishTics();
+        I_EndProfileFrame();
 
         // Figure out how far into the current tic we're in as a fixed_t
         if (vid_capfps != TICRATE)
-            fractionaltic = I_GetTimeMS() * TICRATE % 1000 * FRACUNIT / 1000;
+            fractionaltic = I_GetFractionalTic();
 
         return;
     }
@@ -406,13 +425,118 @@ void D_Display(void)
         blitfunc();             // blit buffer
         mapblitfunc();
 
-#if defined(_WIN32)
-        if (CapFPSEvent)
-            WaitForSingleObject(CapFPSEvent, 1000);
-#endif
+        I_WaitForFrame();
     } while (!done);
 }
 
+//
+// D_BenchmarkLoop
+// Runs the game and renders the player's view as fast as possible, with no
+// window and no input, then outputs the time taken to tic and render each
+// frame.
+//
+static int D_CompareFrameTimes(const void *a, const void *b)
+{
+    const uint64_t  x = *(const uint64_t *)a;
+    const uint64_t  y = *(const uint64_t *)b;
+
+    return ((x > y) - (x < y));
+}
+
+static void D_OutputFrameTimes(const char *name, uint64_t *times, int count, uint64_t frequency)
+{
+    uint64_t    total = 0;
+    double      min, avg, p99;
+
+    for (int i = 0; i < count; i++)
+        total += times[i];
+
+    qsort(times, count, sizeof(*times), D_CompareFrameTimes);
+
+    min = times[0] * 1000.0 / frequency;
+    avg = total * 1000.0 / frequency / count;
+    p99 = times[MIN(count - 1, count * 99 / 100)] * 1000.0 / frequency;
+
+    C_Output("%s: min %.3fms, avg %.3fms, p99 %.3fms.", name, min, avg, p99);
+    printf("%s: min %.3fms, avg %.3fms, p99 %.3fms\n", name, min, avg, p99);
+}
+
+static void D_BenchmarkLoop(void)
+{
+    const uint64_t  frequency = SDL_GetPerformanceFrequency();
+    int             maxframes = (timedemo ? BENCHMARKTICS : benchmarktics);
+    uint64_t        *tictimes = malloc(maxframes * sizeof(*tictimes));
+    uint64_t        *rendertimes = malloc(maxframes * sizeof(*rendertimes));
+    uint64_t        benchmarktime = 0;
+    double          seconds;
+    int             frame = 0;
+    int             maps = 0;
+    dboolean        inlevel = false;
+    char            mapsplayed[256];
+
+    realframe = true;
+    fractionaltic = 0;
+
+    // when playing back a demo, keep going until it ends
+    while (timedemo ? demoplayback : frame < benchmarktics)
+    {
+        uint64_t    ticstart = SDL_GetPerformanceCounter();
+        uint64_t    renderstart;
+
+        G_Ticker();
+        gametime++;
+
+        if (frame == maxframes)
+        {
+            maxframes *= 2;
+            tictimes = I_Realloc(tictimes, maxframes * sizeof(*tictimes));
+            rendertimes = I_Realloc(rendertimes, maxframes * sizeof(*rendertimes));
+        }
+
+        // only time frames while a map is being played, and not intermissions between them
+        if (gamestate != GS_LEVEL)
+        {
+            inlevel = false;
+            continue;
+        }
+
+        if (!inlevel)
+        {
+            inlevel = true;
+            maps++;
+        }
+
+        renderstart = SDL_GetPerformanceCounter();
+        R_RenderPlayerView();
+
+        tictimes[frame] = renderstart - ticstart;
+        rendertimes[frame++] = SDL_GetPerformanceCounter() - renderstart;
+        benchmarktime += SDL_GetPerformanceCounter() - ticstart;
+    }
+
+    if (!frame)
+        I_Error("No frames were rendered.");
+
+    seconds = (double)benchmarktime / frequency;
+
+    if (maps == 1)
+        M_StringCopy(mapsplayed, mapnumandtitle, sizeof(mapsplayed));
+    else
+        M_snprintf(mapsplayed, sizeof(mapsplayed), "%i maps", maps);
+
+    C_Output("%i frames of %s were rendered in %.2f seconds (%.1f FPS).", frame, mapsplayed, seconds, frame / seconds);
+    printf("%i frames of %s were rendered in %.2f seconds (%.1f FPS)\n", frame, mapsplayed, seconds, frame / seconds);
+    D_OutputFrameTimes("Tic", tictimes, frame, frequency);
+    D_OutputFrameTimes("Render", rendertimes, frame, frequency);
+    fflush(stdout);
+
+    free(tictimes);
+    free(rendertimes);
+
+    S_Shutdown();
+    I_Quit(false);
+}
+
 //
 // D_DoomLoop
 //
@@ -432,11 +556,16 @@ static void D_DoomLoop(void)
     viewplayer = &player;
     viewplayer->damagecount = 0;
 
+    if (benchmark)
+        D_BenchmarkLoop();  // never returns
+
     while (true)
     {
         TryRunTics();       // will run at least one tic
 
+        I_StartProfile(PROFILE_SOUNDS);
         S_UpdateSounds();   // move positional sounds
+        I_EndProfile(PROFILE_SOUNDS);
 
         // Update display, next frame, with current state.
         D_Display();
@@ -1834,6 +1963,17 @@ static void D_DoomMainSetup(void)
     if ((devparm = M_CheckParm("-devparm")))
         C_Output("A <b>-devparm</b> parameter was found on the command-line. %s", s_D_DEVSTR);
 
+    if ((p = M_CheckParm("-benchmark")))
+    {
+        benchmark = true;
+
+        if (p < myargc - 1 && atoi(myargv[p + 1]) > 0)
+            benchmarktics = atoi(myargv[p + 1]);
+
+        C_Output("A <b>-benchmark</b> parameter was found on the command-line. %i frames will be rendered as fast as possible "
+            "without a window.", benchmarktics);
+    }
+
     // turbo option
     if ((p = M_CheckParm("-turbo")))
     {
@@ -2220,6 +2360,41 @@ static void D_DoomMainSetup(void)
         }
     }
 
+    if ((p = M_CheckParmWithArgs("-record", 1, 1)))
+        G_RecordDemo(myargv[p + 1]);
+    else if ((p = M_CheckParmWithArgs("-playdemo", 1, 1)) || (p = M_CheckParmWithArgs("-timedemo", 1, 1)))
+    {
+        if (G_DeferredPlayDemo(myargv[p + 1]))
+        {
+            if (M_StringCompare(myargv[p], "-timedemo"))
+            {
+                benchmark = true;
+                timedemo = true;
+            }
+
+            C_Output("A <b>%s</b> parameter was found on the command-line. The demo <b>%s</b> will be played back%s.",
+                myargv[p], myargv[p + 1], (timedemo ? " as fast as possible" : ""));
+
+            if (gamemode == commercial)
+                M_snprintf(lumpname, sizeof(lumpname), "MAP%02i", startmap);
+            else
+                M_snprintf(lumpname, sizeof(lumpname), "E%iM%i", startepisode, startmap);
+
+            autostart = true;
+        }
+    }
+
+    // always warp straight into a map when benchmarking
+    if (benchmark && !autostart)
+    {
+        if (gamemode == commercial)
+            M_snprintf(lumpname, sizeof(lumpname), "MAP%02i", startmap);
+        else
+            M_snprintf(lumpname, sizeof(lumpname), "E%iM%i", startepisode, startmap);
+
+        autostart = true;
+    }
+
     M_Init();
 
     R_Init();
@@ -2304,6 +2479,7 @@ static void D_DoomMainSetup(void)
     }
 
     M_Seed((unsigned int)time(NULL));
+    M_SeedCosmetic((unsigned int)time(NULL));
 
     seconds = striptrailingzero((I_GetTimeMS() - startuptimer) / 1000.0f, 1);
     C_Output("Startup took %s seconds to complete.", seconds);
@@ -59,6 +59,10 @@ extern dboolean         pistolstart;            // [BH] checkparm of -pistolstar
 extern dboolean         fastparm;               // checkparm of -fast
 
 extern dboolean         devparm;                // DEBUG: launched with -devparm
+extern dboolean         benchmark;              // checkparm of -benchmark
+extern dboolean         timedemo;               // checkparm of -timedemo
+extern dboolean         demoplayback;
+extern dboolean         demorecording;
 
 // -----------------------------------------------------
 // Game Mode - identify IWAD as shareware, retail etc.
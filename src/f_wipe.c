@@ -81,10 +81,10 @@ static void wipe_initMelt(void)
     // setup initial column positions
     // (ypos < 0 => not ready to scroll yet)
     ypos = malloc(SCREENWIDTH * sizeof(int));
-    ypos[0] = ypos[1] = -(M_Random() & 15);
+    ypos[0] = ypos[1] = -(M_CosmeticRandom() & 15);
 
     for (int i = 2; i < SCREENWIDTH - 1; i += 2)
-        ypos[i] = ypos[i + 1] = BETWEEN(-15, ypos[i - 1] + (M_Random() % 3) - 1, 0);
+        ypos[i] = ypos[i + 1] = BETWEEN(-15, ypos[i - 1] + (M_CosmeticRandom() % 3) - 1, 0);
 }
 
 static dboolean wipe_doMelt(int tics)
@@ -66,7 +66,32 @@
 #include "w_wad.h"
 #include "wi_stuff.h"
 
+#define DEMOID          "DRDM"
+#define DEMOVERSION     1
+#define DEMOHEADERSIZE  14
+#define DEMOMARKER      0x80
+#define DEMOEXTENSION   ".lmp"
+
+// Bits of the mask that precedes each ticcmd in a demo, indicating which of
+// its fields have changed since the previous tic.
+#define DEMO_FORWARDMOVE    1
+#define DEMO_SIDEMOVE       2
+#define DEMO_ANGLETURN      4
+#define DEMO_BUTTONS        8
+#define DEMO_LOOKDIR        16
+
+// Bits of the flags in a demo's header.
+#define DEMO_FAST               1
+#define DEMO_NOMONSTERS         2
+#define DEMO_RESPAWNMONSTERS    4
+#define DEMO_PISTOLSTART        8
+#define DEMO_REGENHEALTH        16
+#define DEMO_RESPAWNITEMS       32
+
 static void G_DoReborn(void);
+static void G_ReadDemoTiccmd(ticcmd_t *cmd);
+static void G_WriteDemoTiccmd(ticcmd_t *cmd);
+static void G_BeginRecording(skill_t skill, int ep, int map);
 
 static void G_DoNewGame(void);
 static void G_DoCompleted(void);
@@ -87,6 +112,18 @@ static dboolean sendsave;                       // send a save event next tic
 
 dboolean        viewactive;
 
+dboolean        demoplayback;
+dboolean        demorecording;
+dboolean        timedemo;
+
+static char     *demoname;
+static byte     *demobuffer;
+static byte     *demo_p;
+static byte     *demoend;
+static ticcmd_t democmd;                        // previous ticcmd in demo
+static uint32_t demoseed;
+static dboolean demostarted;                    // header written, so ticcmds can follow
+
 int             gametime;
 int             totalkills;                     // for intermission
 int             totalitems;
@@ -922,6 +959,11 @@ void G_Ticker(void)
     // and build new consistency check
     memcpy(&viewplayer->cmd, &localcmds[gametime % BACKUPTICS], sizeof(ticcmd_t));
 
+    if (demoplayback)
+        G_ReadDemoTiccmd(&viewplayer->cmd);
+    else if (demorecording && demostarted)
+        G_WriteDemoTiccmd(&viewplayer->cmd);
+
     // check for special buttons
     if (viewplayer->cmd.buttons & BT_SPECIAL)
     {
@@ -1417,7 +1459,7 @@ void G_DoLoadGame(void)
     loadaction = gameaction;
     gameaction = ga_nothing;
 
-    if (!(save_stream = fopen(savename, "rb")))
+    if (!P_OpenSaveGame(savename))
     {
         C_Warning(1, "<b>%s</b> couldn't be found.", savename);
         loadaction = ga_nothing;
@@ -1426,7 +1468,7 @@ void G_DoLoadGame(void)
 
     if (!P_ReadSaveGameHeader(savedescription))
     {
-        fclose(save_stream);
+        P_CloseSaveGame();
         loadaction = ga_nothing;
         return;
     }
@@ -1456,7 +1498,7 @@ void G_DoLoadGame(void)
     if (!P_ReadSaveGameEOF())
         I_Error("Bad savegame");
 
-    fclose(save_stream);
+    P_CloseSaveGame();
 
     if (setsizeneeded)
         R_ExecuteSetViewSize();
@@ -1519,7 +1561,7 @@ static void G_DoSaveGame(void)
     // and then rename it at the end if it was successfully written.
     // This prevents an existing savegame from being overwritten by
     // a corrupted one, or if a savegame buffer overrun occurs.
-    if (!(save_stream = fopen(temp_savegame_file, "wb")))
+    if (!P_CreateSaveGame(temp_savegame_file))
     {
         menuactive = false;
         C_ShowConsole();
@@ -1527,8 +1569,6 @@ static void G_DoSaveGame(void)
     }
     else
     {
-        char    *backup_savegame_file = M_StringJoin(savegame_file, ".bak", NULL);
-
         if (gameaction == ga_autosavegame)
         {
             M_UpdateSaveGameName(quickSaveSlot);
@@ -1545,16 +1585,8 @@ static void G_DoSaveGame(void)
 
         P_WriteSaveGameEOF();
 
-        // Finish up, close the savegame file.
-        fclose(save_stream);
-
-        // Now rename the temporary savegame file to the actual savegame
-        // file, backing up the old savegame if there was one there.
-        remove(backup_savegame_file);
-        rename(savegame_file, backup_savegame_file);
-        rename(temp_savegame_file, savegame_file);
-
-        free(backup_savegame_file);
+        // Finish up, and write the savegame in the background.
+        P_WriteSaveGame(savegame_file);
 
         if (!consolestrings || !M_StringStartsWith(console[consolestrings - 1].string, "save "))
             C_Input("save %s", savegame_file);
@@ -1742,5 +1774,281 @@ void G_InitNew(skill_t skill, int ep, int map)
             && !M_StringStartsWith(console[consolestrings - 1].string, "Warping ")))
         C_InputNoRepeat("newgame");
 
+    // seed the RNG so a demo plays back exactly as it was recorded
+    if (demoplayback)
+        M_Seed(demoseed);
+    else if (demorecording && !demostarted)
+        G_BeginRecording(skill, ep, map);
+
     G_DoLoadLevel();
 }
+
+//
+// DEMO RECORDING AND PLAYBACK
+// A demo starts with a header containing the skill level, episode, map and
+// RNG seed it was recorded with, followed by a ticcmd for every tic. Each
+// ticcmd is preceded by a mask of the fields that differ from the previous
+// one, and only those fields are stored.
+//
+static void G_ReadDemoTiccmd(ticcmd_t *cmd)
+{
+    int mask;
+
+    if (demo_p >= demoend || (mask = *demo_p++) == DEMOMARKER
+        || demo_p + !!(mask & DEMO_FORWARDMOVE) + !!(mask & DEMO_SIDEMOVE) + 2 * !!(mask & DEMO_ANGLETURN)
+            + !!(mask & DEMO_BUTTONS) + 4 * !!(mask & DEMO_LOOKDIR) > demoend)
+    {
+        // end of demo data stream
+        G_CheckDemoStatus();
+        return;
+    }
+
+    if (mask & DEMO_FORWARDMOVE)
+        democmd.forwardmove = (signed char)*demo_p++;
+
+    if (mask & DEMO_SIDEMOVE)
+        democmd.sidemove = (signed char)*demo_p++;
+
+    if (mask & DEMO_ANGLETURN)
+    {
+        democmd.angleturn = (short)(demo_p[0] | (demo_p[1] << 8));
+        demo_p += 2;
+    }
+
+    if (mask & DEMO_BUTTONS)
+        democmd.buttons = *demo_p++;
+
+    if (mask & DEMO_LOOKDIR)
+    {
+        democmd.lookdir = (int)(demo_p[0] | (demo_p[1] << 8) | (demo_p[2] << 16) | ((uint32_t)demo_p[3] << 24));
+        demo_p += 4;
+    }
+
+    memcpy(cmd, &democmd, sizeof(ticcmd_t));
+}
+
+static void G_WriteDemoTiccmd(ticcmd_t *cmd)
+{
+    int     mask = 0;
+    size_t  position = demo_p - demobuffer;
+
+    // make sure there's room for the largest possible ticcmd, and the end marker
+    if (demo_p + 11 > demoend)
+    {
+        size_t  size = (demoend - demobuffer) * 2;
+
+        demobuffer = I_Realloc(demobuffer, size);
+        demo_p = demobuffer + position;
+        demoend = demobuffer + size;
+    }
+
+    if (cmd->forwardmove != democmd.forwardmove)
+        mask |= DEMO_FORWARDMOVE;
+
+    if (cmd->sidemove != democmd.sidemove)
+        mask |= DEMO_SIDEMOVE;
+
+    if (cmd->angleturn != democmd.angleturn)
+        mask |= DEMO_ANGLETURN;
+
+    if (cmd->buttons != democmd.buttons)
+        mask |= DEMO_BUTTONS;
+
+    if (cmd->lookdir != democmd.lookdir)
+        mask |= DEMO_LOOKDIR;
+
+    *demo_p++ = mask;
+
+    if (mask & DEMO_FORWARDMOVE)
+        *demo_p++ = (byte)cmd->forwardmove;
+
+    if (mask & DEMO_SIDEMOVE)
+        *demo_p++ = (byte)cmd->sidemove;
+
+    if (mask & DEMO_ANGLETURN)
+    {
+        *demo_p++ = (cmd->angleturn & 0xFF);
+        *demo_p++ = ((cmd->angleturn >> 8) & 0xFF);
+    }
+
+    if (mask & DEMO_BUTTONS)
+        *demo_p++ = cmd->buttons;
+
+    if (mask & DEMO_LOOKDIR)
+    {
+        *demo_p++ = (cmd->lookdir & 0xFF);
+        *demo_p++ = ((cmd->lookdir >> 8) & 0xFF);
+        *demo_p++ = ((cmd->lookdir >> 16) & 0xFF);
+        *demo_p++ = (((uint32_t)cmd->lookdir >> 24) & 0xFF);
+    }
+
+    memcpy(&democmd, cmd, sizeof(ticcmd_t));
+}
+
+//
+// G_RecordDemo
+// Called by the startup code when -record is specified on the command-line.
+// Recording begins when the next game starts.
+//
+void G_RecordDemo(char *name)
+{
+    size_t  size = 0x20000;
+
+    demoname = (M_StringEndsWith(name, DEMOEXTENSION) ? M_StringDuplicate(name) : M_StringJoin(name, DEMOEXTENSION, NULL));
+    demobuffer = malloc(size);
+    demo_p = demobuffer;
+    demoend = demobuffer + size;
+    demorecording = true;
+    demostarted = false;
+}
+
+static void G_BeginRecording(skill_t skill, int ep, int map)
+{
+    byte    flags = 0;
+
+    demoseed = (uint32_t)time(NULL);
+    M_Seed(demoseed);
+    memset(&democmd, 0, sizeof(ticcmd_t));
+
+    if (fastparm)
+        flags |= DEMO_FAST;
+
+    if (nomonsters)
+        flags |= DEMO_NOMONSTERS;
+
+    if (respawnmonsters)
+        flags |= DEMO_RESPAWNMONSTERS;
+
+    if (pistolstart)
+        flags |= DEMO_PISTOLSTART;
+
+    if (regenhealth)
+        flags |= DEMO_REGENHEALTH;
+
+    if (respawnitems)
+        flags |= DEMO_RESPAWNITEMS;
+
+    memcpy(demo_p, DEMOID, 4);
+    demo_p += 4;
+    *demo_p++ = DEMOVERSION;
+    *demo_p++ = skill;
+    *demo_p++ = ep;
+    *demo_p++ = map;
+    *demo_p++ = (demoseed & 0xFF);
+    *demo_p++ = ((demoseed >> 8) & 0xFF);
+    *demo_p++ = ((demoseed >> 16) & 0xFF);
+    *demo_p++ = ((demoseed >> 24) & 0xFF);
+    *demo_p++ = flags;
+    *demo_p++ = 0;  // reserved
+
+    demostarted = true;
+
+    C_Output("Recording a demo to <b>%s</b>.", demoname);
+}
+
+//
+// G_DeferredPlayDemo
+// Reads a demo and its header, and sets up a new game to play it back in.
+//
+dboolean G_DeferredPlayDemo(char *name)
+{
+    FILE    *file;
+    long    length;
+    byte    flags;
+
+    if (!M_FileExists(name) && !M_StringEndsWith(name, DEMOEXTENSION))
+        demoname = M_StringJoin(name, DEMOEXTENSION, NULL);
+    else
+        demoname = M_StringDuplicate(name);
+
+    if (!(file = fopen(demoname, "rb")))
+    {
+        C_Warning(1, "<b>%s</b> couldn't be found.", demoname);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    demobuffer = malloc(MAX(length, 1));
+
+    if (length < DEMOHEADERSIZE || fread(demobuffer, 1, length, file) != (size_t)length
+        || memcmp(demobuffer, DEMOID, 4) || demobuffer[4] != DEMOVERSION)
+    {
+        fclose(file);
+        free(demobuffer);
+        demobuffer = NULL;
+        C_Warning(1, "<b>%s</b> isn't a valid demo.", demoname);
+        return false;
+    }
+
+    fclose(file);
+
+    demo_p = demobuffer + 5;
+    demoend = demobuffer + length;
+
+    startskill = (skill_t)*demo_p++;
+    startepisode = *demo_p++;
+    startmap = *demo_p++;
+    demoseed = (demo_p[0] | (demo_p[1] << 8) | (demo_p[2] << 16) | ((uint32_t)demo_p[3] << 24));
+    demo_p += 4;
+    flags = *demo_p++;
+    demo_p++;
+
+    fastparm = !!(flags & DEMO_FAST);
+    nomonsters = !!(flags & DEMO_NOMONSTERS);
+    respawnmonsters = !!(flags & DEMO_RESPAWNMONSTERS);
+    pistolstart = !!(flags & DEMO_PISTOLSTART);
+    regenhealth = !!(flags & DEMO_REGENHEALTH);
+    respawnitems = !!(flags & DEMO_RESPAWNITEMS);
+
+    memset(&democmd, 0, sizeof(ticcmd_t));
+    demoplayback = true;
+
+    return true;
+}
+
+//
+// G_CheckDemoStatus
+// Called when a demo ends, or when quitting. Writes the demo being recorded.
+//
+dboolean G_CheckDemoStatus(void)
+{
+    if (demoplayback)
+    {
+        free(demobuffer);
+        demobuffer = NULL;
+        demoplayback = false;
+
+        // when benchmarking, the benchmark loop ends with the demo
+        if (!timedemo)
+            I_Quit(true);
+
+        return true;
+    }
+
+    if (demorecording)
+    {
+        demorecording = false;
+
+        // nothing was recorded if a game was never started
+        if (demostarted)
+        {
+            *demo_p++ = DEMOMARKER;
+
+            if (M_WriteFile(demoname, demobuffer, demo_p - demobuffer))
+                C_Output("A demo was recorded to <b>%s</b>.", demoname);
+            else
+                C_Warning(1, "<b>%s</b> couldn't be saved.", demoname);
+        }
+
+        demostarted = false;
+
+        free(demobuffer);
+        demobuffer = NULL;
+        return true;
+    }
+
+    return false;
+}
@@ -99,6 +99,10 @@ void G_RemoveChoppers(void);
 
 void G_LoadedGameMessage(void);
 
+void G_RecordDemo(char *name);
+dboolean G_DeferredPlayDemo(char *name);
+dboolean G_CheckDemoStatus(void);
+
 extern fixed_t  forwardmove[2];
 extern fixed_t  sidemove[2];
 extern fixed_t  angleturn[3];
@@ -193,6 +193,9 @@ void HUlib_DrawAltAutomapTextLine(hu_textline_t *l, dboolean external)
     byte            *fb1 = (external ? mapscreen : screens[0]);
     int             len = l->len;
 
+    if (external && !drawmapwindow)
+        return;
+
     for (int i = 0; i < len; i++)
     {
         unsigned char   letter = l->l[i];
@@ -272,6 +275,9 @@ void HUlib_DrawTextLine(hu_textline_t *l, dboolean external)
 
     if (external)
     {
+        if (!drawmapwindow)
+            return;
+
         fb1 = mapscreen;
         fb2 = mapscreen;
     }
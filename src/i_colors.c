@@ -38,8 +38,11 @@
 
 #include <stdlib.h>
 
+#include "c_console.h"
 #include "i_colors.h"
 #include "i_swap.h"
+#include "m_misc.h"
+#include "version.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -207,10 +210,117 @@ int FindDominantColor(patch_t *patch)
     return dominantcolor;
 }
 
-static byte *GenerateTintTable(byte *palette, int percent, byte filter[256], int colors)
+//
+// Nearest color search
+// Finding the nearest color in the palette to each of the colors in a tint table by comparing
+// it to all 256 colors is slow, so the RGB color cube is divided into cells, and each cell is
+// given a list of the only colors in the palette that could be nearest to a color in it. That
+// is, those colors that could be no further from some color in the cell than the furthest
+// that the color that is closest to the whole cell could be. The result is always the same
+// as FindNearestColor().
+//
+#define NEARESTCELLSHIFT    4
+#define NEARESTCELLSIZE     (1 << NEARESTCELLSHIFT)
+#define NEARESTCELLS        (256 >> NEARESTCELLSHIFT)
+
+static byte *nearestpalette;
+static byte *nearestcandidates[NEARESTCELLS * NEARESTCELLS * NEARESTCELLS];
+static int  numnearestcandidates[NEARESTCELLS * NEARESTCELLS * NEARESTCELLS];
+
+static void InitNearestColorSearch(byte *palette)
 {
-    byte    *result = malloc(256 * 256);
+    nearestpalette = palette;
+}
+
+static void FreeNearestColorSearch(void)
+{
+    for (int i = 0; i < NEARESTCELLS * NEARESTCELLS * NEARESTCELLS; i++)
+    {
+        free(nearestcandidates[i]);
+        nearestcandidates[i] = NULL;
+    }
+}
 
+// The distances along an axis from a value to the nearest and furthest ends of a cell
+static void CellDistance(int value, int low, int *nearest, int *furthest)
+{
+    const int   high = low + NEARESTCELLSIZE - 1;
+
+    *nearest = (value < low ? low - value : (value > high ? value - high : 0));
+    *furthest = MAX(ABS(value - low), ABS(value - high));
+}
+
+static void FindNearestColorCandidates(int cell, int red, int green, int blue)
+{
+    // The difference between two colors in FindNearestColor() weights red and blue
+    // by between 2 and 3 depending on the average red, and green by 4.
+    int minimum[256];
+    int best = INT_MAX;
+    int count = 0;
+
+    red &= ~(NEARESTCELLSIZE - 1);
+    green &= ~(NEARESTCELLSIZE - 1);
+    blue &= ~(NEARESTCELLSIZE - 1);
+
+    for (int i = 0; i < 256; i++)
+    {
+        int rnear, rfar;
+        int gnear, gfar;
+        int bnear, bfar;
+
+        CellDistance(nearestpalette[i * 3], red, &rnear, &rfar);
+        CellDistance(nearestpalette[i * 3 + 1], green, &gnear, &gfar);
+        CellDistance(nearestpalette[i * 3 + 2], blue, &bnear, &bfar);
+
+        minimum[i] = 2 * rnear * rnear + 4 * gnear * gnear + 2 * bnear * bnear;
+        best = MIN(best, 3 * rfar * rfar + 4 * gfar * gfar + 3 * bfar * bfar);
+    }
+
+    nearestcandidates[cell] = malloc(256);
+
+    for (int i = 0; i < 256; i++)
+        if (minimum[i] <= best)
+            nearestcandidates[cell][count++] = i;
+
+    numnearestcandidates[cell] = count;
+}
+
+static int FindNearestColorFast(int red, int green, int blue)
+{
+    const int   cell = (((red >> NEARESTCELLSHIFT) * NEARESTCELLS + (green >> NEARESTCELLSHIFT)) * NEARESTCELLS
+                    + (blue >> NEARESTCELLSHIFT));
+    const byte  *candidates;
+    int         bestdiff = INT_MAX;
+    int         bestcolor = 0;
+
+    if (!nearestcandidates[cell])
+        FindNearestColorCandidates(cell, red, green, blue);
+
+    candidates = nearestcandidates[cell];
+
+    for (int i = 0; i < numnearestcandidates[cell]; i++)
+    {
+        // From <https://www.compuphase.com/cmetric.htm>
+        const int   color = candidates[i];
+        const byte  *palette = &nearestpalette[color * 3];
+        const int   rmean = (red + palette[0]) / 2;
+        const int   r = red - palette[0];
+        const int   g = green - palette[1];
+        const int   b = blue - palette[2];
+        const int   diff = (((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8);
+
+        if (diff < bestdiff)
+        {
+            bestcolor = color;
+            bestdiff = diff;
+        }
+    }
+
+    return bestcolor;
+}
+
+static void GenerateTintTable(byte *result, byte *palette, int percent, byte filter[256], int colors)
+{
     for (int foreground = 0; foreground < 256; foreground++)
     {
         if ((filter[foreground] & colors) || colors == ALL || colors == ALTHUD)
@@ -241,45 +351,153 @@ static byte *GenerateTintTable(byte *palette, int percent, byte filter[256], int
 
                 }
 
-                result[(background << 8) + foreground] = FindNearestColor(palette, r, g, b);
+                result[(background << 8) + foreground] = FindNearestColorFast(r, g, b);
             }
         }
         else
             for (int background = 0; background < 256; background++)
                 result[(background << 8) + foreground] = foreground;
     }
+}
+
+typedef struct
+{
+    byte    **table;
+    int     percent;
+    int     colors;
+} tinttable_t;
+
+static tinttable_t tinttables[] =
+{
+    { &tinttab20,         20,       ALL                        },
+    { &tinttab25,         25,       ALL                        },
+    { &tinttab33,         33,       ALL                        },
+    { &tinttab40,         40,       ALL                        },
+    { &tinttab50,         50,       ALL                        },
+    { &tinttab60,         60,       ALL                        },
+    { &tinttab66,         66,       ALL                        },
+    { &tinttab75,         75,       ALL                        },
+    { &alttinttab20,      20,       ALTHUD                     },
+    { &alttinttab40,      40,       ALTHUD                     },
+    { &alttinttab60,      60,       ALTHUD                     },
+    { &tinttabadditive,   ADDITIVE, ALL                        },
+    { &tinttabred,        ADDITIVE, REDS                       },
+    { &tinttabredwhite1,  ADDITIVE, (REDS | WHITES)            },
+    { &tinttabredwhite2,  ADDITIVE, (REDS | WHITES | EXTRAS)   },
+    { &tinttabgreen,      ADDITIVE, GREENS                     },
+    { &tinttabblue,       ADDITIVE, BLUES                      },
+    { &tinttabred33,      33,       REDS                       },
+    { &tinttabredwhite50, 50,       (REDS | WHITES)            },
+    { &tinttabgreen33,    33,       GREENS                     },
+    { &tinttabblue25,     25,       BLUES                      }
+};
+
+#define NUMTINTTABLES   arrlen(tinttables)
+#define TINTTABLESIZE   (256 * 256)
+
+//
+// Tint table cache
+// Once generated, the tint tables are saved to a file along with the palette they were
+// generated from and an ID that is changed whenever the tables are generated differently.
+// If the palette is the same the next time DOOM Retro starts, the file is mapped into memory
+// and the tables are used straight from it instead of being generated again.
+//
+#define TINTCACHEID     PACKAGE_NAME " tint tables 1"
+#define TINTCACHEIDSIZE 32
+#define TINTCACHEHEADER (TINTCACHEIDSIZE + 256 * 3)
+
+static char *TintCacheFile(void)
+{
+    char    *appdatafolder = M_GetAppDataFolder();
+
+    M_MakeDirectory(appdatafolder);
+
+    return M_StringJoin(appdatafolder, DIR_SEPARATOR_S, "tinttables.cache", NULL);
+}
+
+static void TintCacheHeader(byte *header, byte *palette)
+{
+    memset(header, 0, TINTCACHEIDSIZE);
+    M_StringCopy((char *)header, TINTCACHEID, TINTCACHEIDSIZE);
+    memcpy(header + TINTCACHEIDSIZE, palette, 256 * 3);
+}
+
+static dboolean LoadTintTables(char *filename, byte *palette)
+{
+    byte        header[TINTCACHEHEADER];
+    byte        fileheader[TINTCACHEHEADER];
+    byte        *tables;
+    wadfile_t   *file;
+
+    if (!(file = W_OpenFile(filename)))
+        return false;
+
+    TintCacheHeader(header, palette);
+
+    if (W_Read(file, 0, fileheader, TINTCACHEHEADER) != TINTCACHEHEADER || memcmp(header, fileheader, TINTCACHEHEADER))
+    {
+        W_CloseFile(file);
+        return false;
+    }
+
+    // use the tables where they are in the file if it could be mapped into memory, and
+    // otherwise read them from it. Either way, the file is left open.
+    if (!(tables = W_MappedData(file, TINTCACHEHEADER, NUMTINTTABLES * TINTTABLESIZE)))
+    {
+        tables = malloc(NUMTINTTABLES * TINTTABLESIZE);
 
-    return result;
+        if (W_Read(file, TINTCACHEHEADER, tables, NUMTINTTABLES * TINTTABLESIZE) != NUMTINTTABLES * TINTTABLESIZE)
+        {
+            free(tables);
+            W_CloseFile(file);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < NUMTINTTABLES; i++)
+        *tinttables[i].table = tables + i * TINTTABLESIZE;
+
+    return true;
+}
+
+static void SaveTintTables(char *filename, byte *palette, byte *tables)
+{
+    byte    header[TINTCACHEHEADER];
+    byte    *buffer = malloc(TINTCACHEHEADER + NUMTINTTABLES * TINTTABLESIZE);
+
+    TintCacheHeader(header, palette);
+    memcpy(buffer, header, TINTCACHEHEADER);
+    memcpy(buffer + TINTCACHEHEADER, tables, NUMTINTTABLES * TINTTABLESIZE);
+
+    if (!M_WriteFile(filename, buffer, TINTCACHEHEADER + NUMTINTTABLES * TINTTABLESIZE))
+        C_Warning(1, "<b>%s</b> couldn't be saved.", filename);
+
+    free(buffer);
 }
 
 void I_InitTintTables(byte *palette)
 {
-    int lump = W_CheckNumForName("TRANMAP");
+    int     lump = W_CheckNumForName("TRANMAP");
+    char    *filename = TintCacheFile();
 
-    tinttab20 = GenerateTintTable(palette, 20, general, ALL);
-    tinttab25 = GenerateTintTable(palette, 25, general, ALL);
-    tinttab33 = GenerateTintTable(palette, 33, general, ALL);
-    tinttab40 = GenerateTintTable(palette, 40, general, ALL);
-    tinttab50 = GenerateTintTable(palette, 50, general, ALL);
-    tinttab60 = GenerateTintTable(palette, 60, general, ALL);
-    tinttab66 = GenerateTintTable(palette, 66, general, ALL);
-    tinttab75 = GenerateTintTable(palette, 75, general, ALL);
+    if (!LoadTintTables(filename, palette))
+    {
+        byte    *tables = malloc(NUMTINTTABLES * TINTTABLESIZE);
 
-    alttinttab20 = GenerateTintTable(palette, 20, general, ALTHUD);
-    alttinttab40 = GenerateTintTable(palette, 40, general, ALTHUD);
-    alttinttab60 = GenerateTintTable(palette, 60, general, ALTHUD);
+        InitNearestColorSearch(palette);
 
-    tranmap = (lump != -1 ? W_CacheLumpNum(lump) : tinttab50);
+        for (int i = 0; i < NUMTINTTABLES; i++)
+        {
+            *tinttables[i].table = tables + i * TINTTABLESIZE;
+            GenerateTintTable(*tinttables[i].table, palette, tinttables[i].percent, general, tinttables[i].colors);
+        }
 
-    tinttabadditive = GenerateTintTable(palette, ADDITIVE, general, ALL);
-    tinttabred = GenerateTintTable(palette, ADDITIVE, general, REDS);
-    tinttabredwhite1 = GenerateTintTable(palette, ADDITIVE, general, (REDS | WHITES));
-    tinttabredwhite2 = GenerateTintTable(palette, ADDITIVE, general, (REDS | WHITES | EXTRAS));
-    tinttabgreen = GenerateTintTable(palette, ADDITIVE, general, GREENS);
-    tinttabblue = GenerateTintTable(palette, ADDITIVE, general, BLUES);
-
-    tinttabred33 = GenerateTintTable(palette, 33, general, REDS);
-    tinttabredwhite50 = GenerateTintTable(palette, 50, general, (REDS | WHITES));
-    tinttabgreen33 = GenerateTintTable(palette, 33, general, GREENS);
-    tinttabblue25 = GenerateTintTable(palette, 25, general, BLUES);
+        FreeNearestColorSearch();
+
+        SaveTintTables(filename, palette, tables);
+    }
+
+    free(filename);
+
+    tranmap = (lump != -1 ? W_CacheLumpNum(lump) : tinttab50);
 }
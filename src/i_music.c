@@ -42,7 +42,9 @@
 
 #include "c_console.h"
 #include "i_midirpc.h"
+#include "i_system.h"
 #include "m_config.h"
+#include "m_misc.h"
 #include "mmus2mid.h"
 #include "s_sound.h"
 
@@ -51,6 +53,8 @@ dboolean        musmusictype;
 
 static dboolean music_initialized;
 
+static SDL_mutex    *convertedsongsmutex;
+
 static int      current_music_volume;
 static int      paused_midi_volume;
 
@@ -102,6 +106,9 @@ dboolean I_InitMusic(void)
         }
     }
 
+    if (!convertedsongsmutex && !(convertedsongsmutex = SDL_CreateMutex()))
+        return false;
+
     SDL_PauseAudio(0);
 
     music_initialized = true;
@@ -237,6 +244,106 @@ void I_UnRegisterSong(void *handle)
         Mix_FreeMusic(handle);
 }
 
+//
+// Converted songs
+// Each MUS lump is only converted to MIDI the first time it's registered or prefetched. The MIDI
+// is kept for the rest of the session, found by a hash of the lump, and is played straight from
+// memory. mmus2mid() isn't reentrant, so conversions are done while holding a mutex.
+//
+typedef struct
+{
+    uint64_t        hash;
+    int             size;
+    uint8_t         *mid;
+    int             midlen;
+} convertedsong_t;
+
+static convertedsong_t  *convertedsongs;
+static int              numconvertedsongs;
+
+static dboolean I_ConvertSong(uint8_t *data, int size, uint8_t **mid, int *midlen)
+{
+    const uint64_t  hash = M_Hash(FNVOFFSETBASIS, data, size);
+    dboolean        result = false;
+
+    SDL_LockMutex(convertedsongsmutex);
+
+    for (int i = 0; i < numconvertedsongs; i++)
+        if (convertedsongs[i].hash == hash && convertedsongs[i].size == size)
+        {
+            *mid = convertedsongs[i].mid;
+            *midlen = convertedsongs[i].midlen;
+            result = true;
+            break;
+        }
+
+    if (!result)
+    {
+        MIDI    mididata;
+
+        memset(&mididata, 0, sizeof(MIDI));
+
+        if (mmus2mid(data, (size_t)size, &mididata))
+        {
+            convertedsong_t *song;
+
+            // Hurrah! Let's make it a mid and give it to SDL_mixer
+            MIDIToMidi(&mididata, mid, midlen);
+
+            convertedsongs = I_Realloc(convertedsongs, ((size_t)numconvertedsongs + 1) * sizeof(*convertedsongs));
+            song = &convertedsongs[numconvertedsongs++];
+            song->hash = hash;
+            song->size = size;
+            song->mid = *mid;
+            song->midlen = *midlen;
+            result = true;
+        }
+
+        FreeMIDIData(&mididata);
+    }
+
+    SDL_UnlockMutex(convertedsongsmutex);
+
+    return result;
+}
+
+static int SDLCALL I_PrefetchSongThread(void *data)
+{
+    uint8_t *song = data;
+    int     size;
+    uint8_t *mid;
+    int     midlen;
+
+    memcpy(&size, song, sizeof(size));
+    I_ConvertSong(song + sizeof(size), size, &mid, &midlen);
+    free(song);
+
+    return 0;
+}
+
+//
+// I_PrefetchSong
+// Converts a song on another thread, so it's ready to be played when it's registered.
+//
+void I_PrefetchSong(void *data, int size)
+{
+    uint8_t     *song;
+    SDL_Thread  *thread;
+
+    if (!music_initialized || size < 14 || !mmuscheckformat((uint8_t *)data, size))
+        return;
+
+    // the lump may be released before the thread is done with it, so give the thread a copy
+    song = malloc(sizeof(size) + (size_t)size);
+    memcpy(song, &size, sizeof(size));
+    memcpy(song + sizeof(size), data, size);
+
+    if ((thread = SDL_CreateThread(&I_PrefetchSongThread, "I_PrefetchSongThread", song)))
+        SDL_DetachThread(thread);
+    else
+        free(song);
+}
+
 void *I_RegisterSong(void *data, int size)
 {
     if (!music_initialized)
@@ -256,22 +363,14 @@ void *I_RegisterSong(void *data, int size)
                 midimusictype = true;
             else if (mmuscheckformat((uint8_t *)data, size))    // is it a MUS?
             {
-                MIDI    mididata;
                 uint8_t *mid;
                 int     midlen;
 
                 musmusictype = true;
 
-                memset(&mididata, 0, sizeof(MIDI));
-
-                if (!mmus2mid((uint8_t *)data, (size_t)size, &mididata))
+                if (!I_ConvertSong((uint8_t *)data, size, &mid, &midlen))
                     return NULL;
 
-                // Hurrah! Let's make it a mid and give it to SDL_mixer
-                MIDIToMidi(&mididata, &mid, &midlen);
-
-                FreeMIDIData(&mididata);
-
                 data = mid;
                 size = midlen;
                 midimusictype = true;                           // now it's a MIDI
@@ -288,8 +387,12 @@ void *I_RegisterSong(void *data, int size)
             }
 #endif
 
-        if ((rwops = SDL_RWFromMem(data, size)))
-            music = Mix_LoadMUS_RW(rwops, SDL_FALSE);
+        if ((rwops = SDL_RWFromConstMem(data, size)))
+            music = Mix_LoadMUS_RW(rwops, SDL_TRUE);
+
+        // some versions of SDL_mixer can't tell an MP3 apart from its data alone
+        if (!music && !midimusictype && (rwops = SDL_RWFromConstMem(data, size)))
+            music = Mix_LoadMUSType_RW(rwops, MUS_MP3, SDL_TRUE);
 
         return music;
     }
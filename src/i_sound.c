@@ -63,6 +63,13 @@ static allocated_sound_t    *channels_playing[s_channels_max];
 
 static int                  mixer_freq;
 
+// Pitch-shifted sounds are kept once they have finished playing so they can be played again
+// without being pitch-shifted again, up to this many of them. The least recently used ones
+// that aren't playing are freed first.
+#define MAXPITCHEDSOUNDS    64
+
+static int                  numpitchedsounds;
+
 // Doubly-linked list of allocated sounds.
 // When a sound is played, it is moved to the head, so that the oldest sounds not used recently are at the tail.
 static allocated_sound_t    *allocated_sounds_head;
@@ -98,11 +105,26 @@ static void AllocatedSoundUnlink(allocated_sound_t *snd)
 
 static void FreeAllocatedSound(allocated_sound_t *snd)
 {
+    if (snd->pitch != NORM_PITCH)
+        numpitchedsounds--;
+
     // Unlink from linked list.
     AllocatedSoundUnlink(snd);
     free(snd);
 }
 
+// Search from the tail backwards along the allocated sounds list, and free the least recently
+// used pitch-shifted sound that is not in use.
+static void FreeOldestPitchedSound(void)
+{
+    for (allocated_sound_t *snd = allocated_sounds_tail; snd; snd = snd->prev)
+        if (snd->pitch != NORM_PITCH && !snd->use_count)
+        {
+            FreeAllocatedSound(snd);
+            return;
+        }
+}
+
 // Search from the tail backwards along the allocated sounds list, find and free a sound that is
 // not in use, to free up memory. Return true for success.
 static dboolean FindAndFreeSound(void)
@@ -192,6 +214,8 @@ static allocated_sound_t *PitchShift(allocated_sound_t *insnd, int pitch)
     int16_t             *srcbuf = (int16_t *)insnd->chunk.abuf;
     uint32_t            srclen = insnd->chunk.alen;
     int16_t             *dstbuf;
+    uint64_t            step;
+    uint64_t            frac = 0;
 
     // determine ratio pitch:NORM_PITCH and apply to srclen, then invert.
     // This is an approximation of vanilla behavior based on measurements
@@ -201,18 +225,22 @@ static allocated_sound_t *PitchShift(allocated_sound_t *insnd, int pitch)
     if (!(dstlen % 2))
         dstlen++;
 
+    if (numpitchedsounds >= MAXPITCHEDSOUNDS)
+        FreeOldestPitchedSound();
+
     if (!(outsnd = AllocateSound(insnd->sfxinfo, dstlen)))
         return NULL;
 
     outsnd->pitch = pitch;
+    numpitchedsounds++;
     dstbuf = (int16_t *)outsnd->chunk.abuf;
 
-    // loop over output buffer. find corresponding input cell, copy over
-    for (int16_t *inp, *outp = dstbuf; outp < dstbuf + dstlen / 2; outp++)
-    {
-        inp = &srcbuf[(int)((float)(outp - dstbuf) / dstlen * srclen)];
-        *outp = *inp;
-    }
+    // loop over output buffer, stepping through the input buffer in 16.16 fixed point
+    // (64-bit, so sounds longer than 65536 samples don't wrap around)
+    step = ((uint64_t)srclen << 16) / dstlen;
+
+    for (int16_t *outp = dstbuf; outp < dstbuf + dstlen / 2; outp++, frac += step)
+        *outp = srcbuf[frac >> 16];
 
     return outsnd;
 }
@@ -230,10 +258,6 @@ static void ReleaseSoundOnChannel(int channel)
 
     channels_playing[channel] = NULL;
     UnlockAllocatedSound(snd);
-
-    // if the sound is a pitch-shift and it's not in use, immediately free it
-    if (snd->pitch != NORM_PITCH && snd->use_count <= 0)
-        FreeAllocatedSound(snd);
 }
 
 // Generic sound expansion function for any sample rate.
@@ -241,14 +265,18 @@ static dboolean ExpandSoundData(sfxinfo_t *sfxinfo, byte *data, int samplerate,
 {
     unsigned int        expanded_length = (unsigned int)((((uint64_t)length) * mixer_freq) / samplerate);
     allocated_sound_t   *snd = AllocateSound(sfxinfo, expanded_length * 4);
-    int16_t             *expanded = (int16_t *)(&snd->chunk)->abuf;
+    int16_t             *expanded;
     int                 expand_ratio = (length << 8) / expanded_length;
     double              dt = 1.0 / mixer_freq;
-    double              alpha = dt / (1.0 / (M_PI * samplerate) + dt);
+
+    // low-pass filter coefficient in 16.16 fixed point
+    int                 alpha = (int)(dt / (1.0 / (M_PI * samplerate) + dt) * FRACUNIT);
 
     if (!snd)
         return false;
 
+    expanded = (int16_t *)snd->chunk.abuf;
+
     for (unsigned int i = 0; i < expanded_length; i++)
     {
         byte    src = data[(i * expand_ratio) >> 8];
@@ -258,7 +286,7 @@ static dboolean ExpandSoundData(sfxinfo_t *sfxinfo, byte *data, int samplerate,
 
     // Apply low-pass filter
     for (unsigned int i = 2; i < expanded_length * 2; i++)
-        expanded[i] = (int16_t)(alpha * expanded[i] + (1 - alpha) * expanded[i - 2]);
+        expanded[i] = (int16_t)((alpha * expanded[i] + (FRACUNIT - alpha) * expanded[i - 2]) >> FRACBITS);
 
     return true;
 }
@@ -323,15 +351,11 @@ int I_StartSound(sfxinfo_t *sfxinfo, int channel, int vol, int sep, int pitch)
             allocated_sound_t   *newsnd = PitchShift(snd, pitch);
 
             if (newsnd)
-            {
-                LockAllocatedSound(newsnd);
-                UnlockAllocatedSound(snd);
                 snd = newsnd;
-            }
         }
     }
-    else
-        LockAllocatedSound(snd);
+
+    LockAllocatedSound(snd);
 
     // play sound
     Mix_PlayChannel(channel, &snd->chunk, 0);
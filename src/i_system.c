@@ -50,10 +50,14 @@
 
 #include "c_console.h"
 #include "d_main.h"
+#include "doomstat.h"
+#include "g_game.h"
 #include "i_gamepad.h"
 #include "i_timer.h"
 #include "m_config.h"
 #include "m_misc.h"
+#include "p_saveg.h"
+#include "r_data.h"
 #include "s_sound.h"
 #include "version.h"
 
@@ -221,6 +225,16 @@ void I_ShutdownWindows32(void);
 
 void I_Quit(dboolean shutdown)
 {
+    // write the demo being recorded
+    if (demorecording)
+        G_CheckDemoStatus();
+
+    // finish writing a savegame
+    P_WaitForSaveGame();
+
+    // stop precaching the level
+    R_WaitForPrecache(true);
+
     if (shutdown)
     {
         D_FadeScreen();
@@ -36,9 +36,45 @@
 ========================================================================
 */
 
+#include <math.h>
+
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
 #include "SDL.h"
 
 #include "doomdef.h"
+#include "i_timer.h"
+#include "m_fixed.h"
+
+//
+// Timer
+// All times are measured from the first time the timer is read using the performance counter,
+// rather than SDL_GetTicks(), so that how far into the current tic a frame is drawn is known to
+// well under a millisecond.
+//
+static uint64_t timerstart;
+static uint64_t timerfrequency;
+
+static uint64_t I_GetCounter(void)
+{
+    const uint64_t  counter = SDL_GetPerformanceCounter();
+
+    if (!timerfrequency)
+    {
+        timerfrequency = SDL_GetPerformanceFrequency();
+        timerstart = counter;
+    }
+
+    return (counter - timerstart);
+}
+
+// Convert counter ticks to the given number of units a second without overflowing
+static uint64_t I_CounterToUnits(uint64_t counter, uint64_t units)
+{
+    return (counter / timerfrequency * units + counter % timerfrequency * units / timerfrequency);
+}
 
 //
 // I_GetTime
@@ -46,7 +82,7 @@
 //
 int I_GetTime(void)
 {
-    return (SDL_GetTicks() * TICRATE / 1000);
+    return (int)I_CounterToUnits(I_GetCounter(), TICRATE);
 }
 
 //
@@ -54,7 +90,18 @@ int I_GetTime(void)
 //
 int I_GetTimeMS(void)
 {
-    return SDL_GetTicks();
+    return (int)I_CounterToUnits(I_GetCounter(), 1000);
+}
+
+//
+// I_GetFractionalTic
+// Returns how far into the current tic it is as a fixed_t
+//
+fixed_t I_GetFractionalTic(void)
+{
+    const uint64_t  counter = I_GetCounter();
+
+    return (fixed_t)((counter % timerfrequency * TICRATE % timerfrequency) * FRACUNIT / timerfrequency);
 }
 
 //
@@ -69,9 +116,238 @@ void I_InitTimer(void)
 {
     // initialize timer
     SDL_InitSubSystem(SDL_INIT_TIMER);
+    I_GetCounter();
+}
+
+//
+// Frame pacer
+// When the framerate is capped, I_WaitForFrame() waits until the next frame is due. Each frame
+// is due a fixed period after the last was due, rather than after it was drawn, so the cap is
+// met exactly on average. Most of the wait is slept, and the rest is spun, since sleeps can
+// overshoot. How long is spun adapts to how much recent sleeps have overshot by. The time
+// between the last PACERFRAMES frames is kept so its average, jitter and worst can be shown.
+//
+#define PACERFRAMES         64
+#define PACERMINSPIN        250     // microseconds
+#define PACERMAXSPIN        4000
+
+static uint64_t framecap;
+static uint64_t nextframe;
+static uint64_t lastframe;
+static uint64_t spintime;
+static uint64_t pacerhistory[PACERFRAMES];
+static int      pacerframes;
+static int      pacerindex;
+
+static void I_SleepCounter(uint64_t duration)
+{
+#if defined(_WIN32)
+    SDL_Delay((Uint32)I_CounterToUnits(duration, 1000));
+#else
+    const uint64_t  nanoseconds = I_CounterToUnits(duration, 1000000000);
+    struct timespec time = { (time_t)(nanoseconds / 1000000000), (long)(nanoseconds % 1000000000) };
+
+    nanosleep(&time, NULL);
+#endif
+}
+
+void I_CapFPS(int cap)
+{
+    I_GetCounter();
+
+    framecap = (cap && cap != TICRATE ? timerfrequency / cap : 0);
+    nextframe = 0;
+    spintime = timerfrequency * PACERMAXSPIN / 1000000;
+}
+
+void I_WaitForFrame(void)
+{
+    uint64_t    now = I_GetCounter();
+
+    if (framecap)
+    {
+        // start again from now if the last frame is long overdue
+        if (!nextframe || now > nextframe + framecap)
+            nextframe = now;
+        else
+            while (now < nextframe)
+            {
+                const uint64_t  remaining = nextframe - now;
+
+                if (remaining > spintime)
+                {
+                    const uint64_t  duration = remaining - spintime;
+                    const uint64_t  minspin = timerfrequency * PACERMINSPIN / 1000000;
+                    const uint64_t  maxspin = timerfrequency * PACERMAXSPIN / 1000000;
+                    uint64_t        overshoot;
+
+                    I_SleepCounter(duration);
+                    overshoot = MAX(I_GetCounter() - now, duration) - duration;
+
+                    // spin for as long as the worst recent overshoot, easing down when sleeps are accurate
+                    spintime = BETWEEN(minspin, (overshoot > spintime ? overshoot : spintime - (spintime - overshoot) / 16),
+                        maxspin);
+                }
+
+                now = I_GetCounter();
+            }
+
+        nextframe += framecap;
+    }
+
+    if (lastframe)
+    {
+        pacerhistory[pacerindex] = now - lastframe;
+        pacerindex = (pacerindex + 1) % PACERFRAMES;
+        pacerframes = MIN(pacerframes + 1, PACERFRAMES);
+    }
+
+    lastframe = now;
+}
+
+//
+// I_GetFramePacing
+// Returns the average time between the last PACERFRAMES frames, its standard deviation, and
+// the longest, in milliseconds.
+//
+void I_GetFramePacing(double *average, double *jitter, double *worst)
+{
+    const double    frequency = (double)timerfrequency / 1000.0;
+    double          total = 0.0;
+    double          variance = 0.0;
+    uint64_t        most = 0;
+
+    *average = 0.0;
+    *jitter = 0.0;
+    *worst = 0.0;
+
+    if (!pacerframes)
+        return;
+
+    for (int i = 0; i < pacerframes; i++)
+    {
+        total += pacerhistory[i] / frequency;
+        most = MAX(most, pacerhistory[i]);
+    }
+
+    *average = total / pacerframes;
+
+    for (int i = 0; i < pacerframes; i++)
+    {
+        const double    difference = pacerhistory[i] / frequency - *average;
+
+        variance += difference * difference;
+    }
+
+    *jitter = sqrt(variance / pacerframes);
+    *worst = most / frequency;
 }
 
 void I_ShutdownTimer(void)
 {
+    I_StopProfileCSV();
     SDL_QuitSubSystem(SDL_INIT_TIMER);
 }
+
+//
+// Profiler
+// The time spent in each stage of a frame is added up between calls to I_StartProfile() and
+// I_EndProfile() (since some stages, such as running thinkers, happen once for each tic run
+// during the frame), and kept for the last PROFILEFRAMES frames so the average and worst
+// times can be shown. Each frame's times can also be written to a CSV file.
+//
+#define PROFILEFRAMES   64
+
+dboolean        profiling;
+
+const char      *profilestagenames[NUMPROFILESTAGES] =
+{
+    "BSP", "Planes", "Masked", "Thinkers", "Sounds", "HUD", "Console", "Blit"
+};
+
+static uint64_t profilestart[NUMPROFILESTAGES];
+static uint64_t profileframe[NUMPROFILESTAGES];
+static uint64_t profilehistory[NUMPROFILESTAGES][PROFILEFRAMES];
+static int      profileframes;
+static int      profileindex;
+static FILE     *profilecsv;
+
+void I_StartProfile(profilestage_t stage)
+{
+    if (profiling)
+        profilestart[stage] = SDL_GetPerformanceCounter();
+}
+
+void I_EndProfile(profilestage_t stage)
+{
+    if (profiling)
+        profileframe[stage] += SDL_GetPerformanceCounter() - profilestart[stage];
+}
+
+void I_EndProfileFrame(void)
+{
+    if (!profiling)
+        return;
+
+    for (int i = 0; i < NUMPROFILESTAGES; i++)
+    {
+        profilehistory[i][profileindex] = profileframe[i];
+        profileframe[i] = 0;
+    }
+
+    if (profilecsv)
+    {
+        const double    frequency = (double)SDL_GetPerformanceFrequency() / 1000.0;
+
+        for (int i = 0; i < NUMPROFILESTAGES; i++)
+            fprintf(profilecsv, (i < NUMPROFILESTAGES - 1 ? "%.3f," : "%.3f\n"), profilehistory[i][profileindex] / frequency);
+    }
+
+    profileindex = (profileindex + 1) % PROFILEFRAMES;
+    profileframes = MIN(profileframes + 1, PROFILEFRAMES);
+}
+
+//
+// I_GetProfile
+// Returns the average and worst times in milliseconds spent in a stage over the last
+// PROFILEFRAMES frames.
+//
+void I_GetProfile(profilestage_t stage, double *average, double *worst)
+{
+    const double    frequency = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    uint64_t        total = 0;
+    uint64_t        most = 0;
+
+    for (int i = 0; i < profileframes; i++)
+    {
+        const uint64_t  time = profilehistory[stage][i];
+
+        total += time;
+        most = MAX(most, time);
+    }
+
+    *average = (profileframes ? total / frequency / profileframes : 0.0);
+    *worst = most / frequency;
+}
+
+dboolean I_StartProfileCSV(const char *filename)
+{
+    I_StopProfileCSV();
+
+    if (!(profilecsv = fopen(filename, "wt")))
+        return false;
+
+    for (int i = 0; i < NUMPROFILESTAGES; i++)
+        fprintf(profilecsv, (i < NUMPROFILESTAGES - 1 ? "%s," : "%s\n"), profilestagenames[i]);
+
+    return true;
+}
+
+void I_StopProfileCSV(void)
+{
+    if (profilecsv)
+    {
+        fclose(profilecsv);
+        profilecsv = NULL;
+    }
+}
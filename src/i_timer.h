@@ -39,6 +39,9 @@
 #if !defined(__I_TIMER_H__)
 #define __I_TIMER_H__
 
+#include "doomtype.h"
+#include "m_fixed.h"
+
 // Called by D_DoomLoop,
 // returns current time in tics.
 int I_GetTime(void);
@@ -46,6 +49,9 @@ int I_GetTime(void);
 // returns current time in ms
 int I_GetTimeMS(void);
 
+// returns how far into the current tic it is
+fixed_t I_GetFractionalTic(void);
+
 // Pause for a specified number of ms
 void I_Sleep(int ms);
 
@@ -54,4 +60,33 @@ void I_InitTimer(void);
 
 void I_ShutdownTimer(void);
 
+// Frame pacer
+void I_CapFPS(int cap);
+void I_WaitForFrame(void);
+void I_GetFramePacing(double *average, double *jitter, double *worst);
+
+// Stages of each frame that are timed by the profiler
+typedef enum
+{
+    PROFILE_BSP,
+    PROFILE_PLANES,
+    PROFILE_MASKED,
+    PROFILE_THINKERS,
+    PROFILE_SOUNDS,
+    PROFILE_HUD,
+    PROFILE_CONSOLE,
+    PROFILE_BLIT,
+    NUMPROFILESTAGES
+} profilestage_t;
+
+extern dboolean     profiling;
+extern const char   *profilestagenames[NUMPROFILESTAGES];
+
+void I_StartProfile(profilestage_t stage);
+void I_EndProfile(profilestage_t stage);
+void I_EndProfileFrame(void);
+void I_GetProfile(profilestage_t stage, double *average, double *worst);
+dboolean I_StartProfileCSV(const char *filename);
+void I_StopProfileCSV(void);
+
 #endif
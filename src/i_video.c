@@ -72,7 +72,7 @@
 #define MAXUPSCALEWIDTH     (1600 / ORIGINALWIDTH)
 #define MAXUPSCALEHEIGHT    (1200 / ORIGINALHEIGHT)
 
-#define SHAKEANGLE          ((double)M_RandomInt(-1000, 1000) * r_shake_damage / 100000.0)
+#define SHAKEANGLE          ((double)M_CosmeticRandomInt(-1000, 1000) * r_shake_damage / 100000.0)
 
 #if !defined(SDL_VIDEO_RENDER_D3D11)
 #define SDL_VIDEO_RENDER_D3D11  0
@@ -111,17 +111,23 @@ static SDL_Surface  *surface;
 static SDL_Surface  *buffer;
 static SDL_Palette  *palette;
 static SDL_Color    colors[256];
+static uint32_t     palettetable[256];
+static int          motionblur;
+static dboolean     motionblurring;
 byte                *PLAYPAL;
 
 static byte         *oscreen;
 byte                *mapscreen;
 SDL_Window          *mapwindow;
+dboolean            drawmapwindow = true;
+static int          mapwindowtic = -1;
 SDL_Renderer        *maprenderer;
 static SDL_Texture  *maptexture;
 static SDL_Texture  *maptexture_upscaled;
 static SDL_Surface  *mapsurface;
 static SDL_Surface  *mapbuffer;
 static SDL_Palette  *mappalette;
+static uint32_t     mappalettetable[256];
 
 static dboolean     nearestlinear;
 static int          upscaledwidth;
@@ -186,10 +192,6 @@ static SDL_Rect     map_rect;
 int                 framespersecond;
 int                 refreshrate;
 
-#if defined(_WIN32)
-HANDLE              CapFPSEvent;
-#endif
-
 static dboolean     capslock;
 dboolean            alwaysrun = alwaysrun_default;
 
@@ -305,44 +307,6 @@ dboolean keystate(int key)
     return state[TranslateKey2(key)];
 }
 
-void I_CapFPS(int cap)
-{
-#if defined(_WIN32)
-    static UINT CapFPSTimer;
-
-    if (CapFPSTimer)
-    {
-        timeKillEvent(CapFPSTimer);
-        CapFPSTimer = 0;
-    }
-
-    if (!cap || cap == TICRATE)
-    {
-        if (CapFPSEvent)
-        {
-            CloseHandle(CapFPSEvent);
-            CapFPSEvent = NULL;
-        }
-    }
-    else
-    {
-        if (!CapFPSEvent)
-            CapFPSEvent = CreateEvent(NULL, FALSE, TRUE, NULL);
-
-        if (CapFPSEvent)
-        {
-            CapFPSTimer = timeSetEvent(1000 / cap, 0, (LPTIMECALLBACK)CapFPSEvent, 0, (TIME_PERIODIC | TIME_CALLBACK_EVENT_SET));
-
-            if (!CapFPSTimer)
-            {
-                CloseHandle(CapFPSEvent);
-                CapFPSEvent = NULL;
-            }
-        }
-    }
-#endif
-}
-
 static void FreeSurfaces(void)
 {
     SDL_FreePalette(palette);
@@ -374,6 +338,9 @@ static void SetCapsLockState(dboolean enabled)
 {
     Display *dpy = XOpenDisplay(0);
 
+    if (!dpy)
+        return;
+
     XkbLockModifiers(dpy, XkbUseCoreKbd, 2, enabled * 2);
     XFlush(dpy);
     XCloseDisplay(dpy);
@@ -413,6 +380,18 @@ static short __inline clamp(short value, short deadzone)
 dboolean    altdown;
 dboolean    waspaused;
 
+//
+// Set a palette's colors, and make a table of them in the texture's ARGB8888 format with the
+// gamma and brightness already applied for UpdateTexture() to expand pixels through.
+//
+static void SetPaletteTable(uint32_t *table, SDL_Palette *pal)
+{
+    SDL_SetPaletteColors(pal, colors, 0, 256);
+
+    for (int i = 0; i < 256; i++)
+        table[i] = (0xFF000000 | (colors[i].r << 16) | (colors[i].g << 8) | colors[i].b);
+}
+
 static void I_GetEvent(void)
 {
     SDL_Event   SDLEvent;
@@ -672,7 +651,7 @@ static void I_GetEvent(void)
                             break;
 
                         case SDL_WINDOWEVENT_EXPOSED:
-                            SDL_SetPaletteColors(palette, colors, 0, 256);
+                            SetPaletteTable(palettetable, palette);
                             break;
 
                         case SDL_WINDOWEVENT_SIZE_CHANGED:
@@ -815,11 +794,80 @@ static void CalculateFPS(void)
     C_UpdateFPS();
 }
 
+//
+// Expand the 8-bit pixels of a surface straight into a streaming texture through the table
+// made by SetPaletteTable(). Motion blur still blends the surface onto the previous frame in
+// a 32-bit buffer and uploads that.
+//
+static void UpdateTexture(SDL_Texture *dest, SDL_Surface *src, SDL_Surface *intermediate,
+    SDL_Rect *rect, const uint32_t *table, dboolean blend)
+{
+    void    *pixels;
+    int     pitch;
+
+    if (!blend && !SDL_LockTexture(dest, rect, &pixels, &pitch))
+    {
+        for (int y = 0; y < rect->h; y++)
+        {
+            const byte  *source = (const byte *)src->pixels + (size_t)y * src->pitch;
+            uint32_t    *destination = (uint32_t *)((byte *)pixels + (size_t)y * pitch);
+            int         x = 0;
+
+            for (; x < rect->w - 3; x += 4)
+            {
+                destination[x] = table[source[x]];
+                destination[x + 1] = table[source[x + 1]];
+                destination[x + 2] = table[source[x + 2]];
+                destination[x + 3] = table[source[x + 3]];
+            }
+
+            for (; x < rect->w; x++)
+                destination[x] = table[source[x]];
+        }
+
+        SDL_UnlockTexture(dest);
+    }
+    else
+    {
+        SDL_LowerBlit(src, rect, intermediate, rect);
+        SDL_UpdateTexture(dest, rect, intermediate->pixels, SCREENWIDTH * 4);
+    }
+}
+
+static void UpdateScreenTexture(void)
+{
+    const int   percent = motionblur;
+
+    if (percent)
+    {
+        // the previous frame was expanded straight into the texture, so put this one in the buffer to blend onto
+        if (!motionblurring)
+        {
+            SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+            SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
+            motionblurring = true;
+        }
+
+        SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE - 128 * percent / 100);
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_BLEND);
+    }
+    else if (motionblurring)
+    {
+        SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE);
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        motionblurring = false;
+    }
+
+    UpdateTexture(texture, surface, buffer, &src_rect, palettetable, motionblurring);
+}
+
+#define UPDATETEXTURE       UpdateScreenTexture()
+#define UPDATEMAPTEXTURE    UpdateTexture(maptexture, mapsurface, mapbuffer, &map_rect, mappalettetable, false)
+
 #if defined(_WIN32)
 void I_WindowResizeBlit(void)
 {
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
 
     if (nearestlinear)
@@ -840,8 +888,7 @@ static void I_Blit(void)
 {
     UpdateGrab();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
     SDL_RenderPresent(renderer);
@@ -851,8 +898,7 @@ static void I_Blit_NearestLinear(void)
 {
     UpdateGrab();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_SetRenderTarget(renderer, texture_upscaled);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
@@ -866,8 +912,7 @@ static void I_Blit_ShowFPS(void)
     UpdateGrab();
     CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
     SDL_RenderPresent(renderer);
@@ -878,8 +923,7 @@ static void I_Blit_NearestLinear_ShowFPS(void)
     UpdateGrab();
     CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_SetRenderTarget(renderer, texture_upscaled);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
@@ -892,8 +936,7 @@ static void I_Blit_Shake(void)
 {
     UpdateGrab();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
     SDL_RenderCopyEx(renderer, texture, &src_rect, NULL, SHAKEANGLE, NULL, SDL_FLIP_NONE);
@@ -904,8 +947,7 @@ static void I_Blit_NearestLinear_Shake(void)
 {
     UpdateGrab();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_SetRenderTarget(renderer, texture_upscaled);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
@@ -920,8 +962,7 @@ static void I_Blit_ShowFPS_Shake(void)
     UpdateGrab();
     CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
     SDL_RenderCopyEx(renderer, texture, &src_rect, NULL, SHAKEANGLE, NULL, SDL_FLIP_NONE);
@@ -933,8 +974,7 @@ static void I_Blit_NearestLinear_ShowFPS_Shake(void)
     UpdateGrab();
     CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, &src_rect, buffer->pixels, SCREENWIDTH * 4);
+    UPDATETEXTURE;
     SDL_RenderClear(renderer);
     SDL_SetRenderTarget(renderer, texture_upscaled);
     SDL_RenderCopy(renderer, texture, &src_rect, NULL);
@@ -946,8 +986,7 @@ static void I_Blit_NearestLinear_ShowFPS_Shake(void)
 
 static void I_Blit_Automap(void)
 {
-    SDL_LowerBlit(mapsurface, &map_rect, mapbuffer, &map_rect);
-    SDL_UpdateTexture(maptexture, &map_rect, mapbuffer->pixels, SCREENWIDTH * 4);
+    UPDATEMAPTEXTURE;
     SDL_RenderClear(maprenderer);
     SDL_RenderCopy(maprenderer, maptexture, &map_rect, NULL);
     SDL_RenderPresent(maprenderer);
@@ -955,8 +994,7 @@ static void I_Blit_Automap(void)
 
 static void I_Blit_Automap_NearestLinear(void)
 {
-    SDL_LowerBlit(mapsurface, &map_rect, mapbuffer, &map_rect);
-    SDL_UpdateTexture(maptexture, &map_rect, mapbuffer->pixels, SCREENWIDTH * 4);
+    UPDATEMAPTEXTURE;
     SDL_RenderClear(maprenderer);
     SDL_SetRenderTarget(maprenderer, maptexture_upscaled);
     SDL_RenderCopy(maprenderer, maptexture, &map_rect, NULL);
@@ -965,10 +1003,33 @@ static void I_Blit_Automap_NearestLinear(void)
     SDL_RenderPresent(maprenderer);
 }
 
+//
+// The external automap is only drawn and blitted once each tic, rather than every frame, so it
+// doesn't slow down the main window when the frame rate is uncapped.
+//
+void I_UpdateMapWindow(void)
+{
+    if (mapwindow)
+    {
+        const int   tic = I_GetTime();
+
+        if ((drawmapwindow = (tic != mapwindowtic)))
+            mapwindowtic = tic;
+    }
+    else
+    {
+        drawmapwindow = true;
+        mapwindowtic = -1;
+    }
+}
+
 void I_UpdateBlitFunc(dboolean shake)
 {
     dboolean    override = (vid_fullscreen && !(displayheight % ORIGINALHEIGHT));
 
+    if (benchmark)
+        return;
+
     if (shake && !software)
         blitfunc = (vid_showfps ? (nearestlinear && !override ? I_Blit_NearestLinear_ShowFPS_Shake :
             I_Blit_ShowFPS_Shake) : (nearestlinear && !override ? I_Blit_NearestLinear_Shake : I_Blit_Shake));
@@ -1010,7 +1071,7 @@ void I_SetPalette(byte *playpal)
         }
     }
 
-    SDL_SetPaletteColors(palette, colors, 0, 256);
+    SetPaletteTable(palettetable, palette);
 
     if (vid_pillarboxes)
         SDL_SetRenderDrawColor(renderer, colors[0].r, colors[0].g, colors[0].b, SDL_ALPHA_OPAQUE);
@@ -1020,7 +1081,7 @@ void I_SetExternalAutomapPalette(void)
 {
     if (mappalette)
     {
-        SDL_SetPaletteColors(mappalette, colors, 0, 256);
+        SetPaletteTable(mappalettetable, mappalette);
         mapblitfunc();
     }
 }
@@ -1034,7 +1095,7 @@ void I_SetSimplePalette(byte *playpal)
         colors[i].b = *playpal++;
     }
 
-    SDL_SetPaletteColors(palette, colors, 0, 256);
+    SetPaletteTable(palettetable, palette);
 }
 
 void I_SetPaletteWithBrightness(byte *playpal, double brightness)
@@ -1065,7 +1126,7 @@ void I_SetPaletteWithBrightness(byte *playpal, double brightness)
         }
     }
 
-    SDL_SetPaletteColors(palette, colors, 0, 256);
+    SetPaletteTable(palettetable, palette);
 
     if (vid_pillarboxes)
         SDL_SetRenderDrawColor(renderer, colors[0].r, colors[0].g, colors[0].b, SDL_ALPHA_OPAQUE);
@@ -1100,7 +1161,7 @@ void I_CreateExternalAutomap(int outputlevel)
     mapscreen = *screens;
     mapblitfunc = nullfunc;
 
-    if (!am_external)
+    if (!am_external || benchmark)
         return;
 
     GetDisplays();
@@ -1146,7 +1207,7 @@ void I_CreateExternalAutomap(int outputlevel)
 
     mappalette = SDL_AllocPalette(256);
     SDL_SetSurfacePalette(mapsurface, mappalette);
-    SDL_SetPaletteColors(mappalette, colors, 0, 256);
+    SetPaletteTable(mappalettetable, mappalette);
 
     mapscreen = mapsurface->pixels;
     map_rect.w = SCREENWIDTH;
@@ -1319,18 +1380,11 @@ static void PositionOnCurrentDisplay(void)
         SDL_SetWindowPosition(window, windowx, windowy);
 }
 
+// Motion blur is only applied when the next frame is blitted, as the game may be running on
+// another thread while the surface is being blitted.
 void I_SetMotionBlur(int percent)
 {
-    if (percent)
-    {
-        SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE - 128 * percent / 100);
-        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_BLEND);
-    }
-    else
-    {
-        SDL_SetSurfaceAlphaMod(surface, SDL_ALPHA_OPAQUE);
-        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
-    }
+    motionblur = percent;
 }
 
 static void SetVideoMode(dboolean output)
@@ -1786,7 +1840,7 @@ void I_ToggleWidescreen(dboolean toggle)
     returntowidescreen = false;
     setsizeneeded = true;
 
-    SDL_SetPaletteColors(palette, colors, 0, 256);
+    SetPaletteTable(palettetable, palette);
 }
 
 #if defined(_WIN32)
@@ -1929,6 +1983,16 @@ void I_InitGraphics(void)
 
     I_InitGammaTables();
 
+    // when benchmarking, render into a buffer in memory without creating a window
+    if (benchmark)
+    {
+        screens[0] = malloc(SCREENWIDTH * SCREENHEIGHT);
+        mapscreen = oscreen = malloc(SCREENWIDTH * SCREENHEIGHT);
+        blitfunc = nullfunc;
+        mapblitfunc = nullfunc;
+        return;
+    }
+
 #if !defined(_WIN32)
     if (*vid_driver)
         SDL_setenv("SDL_VIDEODRIVER", vid_driver, true);
@@ -57,7 +57,6 @@ dboolean GetCapsLockState(void);
 void I_InitGraphics(void);
 void I_RestartGraphics(void);
 void I_ShutdownGraphics(void);
-void I_CapFPS(int cap);
 
 void GetWindowPosition(void);
 void GetWindowSize(void);
@@ -88,6 +87,7 @@ void I_WindowResizeBlit(void);
 
 void (*blitfunc)(void);
 void (*mapblitfunc)(void);
+void I_UpdateMapWindow(void);
 
 extern dboolean     sendpause;
 extern dboolean     quitting;
@@ -114,6 +114,7 @@ extern SDL_Window   *window;
 extern SDL_Renderer *renderer;
 
 extern SDL_Window   *mapwindow;
+extern dboolean     drawmapwindow;
 extern SDL_Renderer *maprenderer;
 extern byte         *mapscreen;
 
@@ -56,7 +56,7 @@ extern char     *packageconfig;
 extern dboolean vanilla;
 extern dboolean togglingvanilla;
 
-#define NUMCVARS                                    180
+#define NUMCVARS                                    184
 
 #define CONFIG_VARIABLE_INT(name, set)              { #name, &name, DEFAULT_INT,           set          }
 #define CONFIG_VARIABLE_INT_UNSIGNED(name, set)     { #name, &name, DEFAULT_INT_UNSIGNED,  set          }
@@ -170,7 +170,9 @@ static default_t cvars[NUMCVARS] =
     CONFIG_VARIABLE_INT          (r_shake_barrels,                                   BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_INT_PERCENT  (r_shake_damage,                                    NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (r_skycolor,                                        SKYVALUEALIAS      ),
+    CONFIG_VARIABLE_INT          (r_texturecache,                                    NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (r_textures,                                        BOOLVALUEALIAS     ),
+    CONFIG_VARIABLE_INT          (r_threads,                                         NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (r_translucency,                                    BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_INT          (s_channels,                                        NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT_PERCENT  (s_musicvolume,                                     NOVALUEALIAS       ),
@@ -178,6 +180,7 @@ static default_t cvars[NUMCVARS] =
     CONFIG_VARIABLE_INT          (s_randompitch,                                     BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_INT_PERCENT  (s_sfxvolume,                                       NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (s_stereo,                                          BOOLVALUEALIAS     ),
+    CONFIG_VARIABLE_INT          (savecompression,                                   BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_INT          (savegame,                                          NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (skilllevel,                                        NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT_PERCENT  (stillbob,                                          NOVALUEALIAS       ),
@@ -194,6 +197,7 @@ static default_t cvars[NUMCVARS] =
     CONFIG_VARIABLE_INT          (vid_fullscreen,                                    BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_INT_PERCENT  (vid_motionblur,                                    NOVALUEALIAS       ),
     CONFIG_VARIABLE_INT          (vid_pillarboxes,                                   BOOLVALUEALIAS     ),
+    CONFIG_VARIABLE_INT          (vid_pipeline,                                      BOOLVALUEALIAS     ),
     CONFIG_VARIABLE_STRING       (vid_scaleapi,                                      NOVALUEALIAS       ),
     CONFIG_VARIABLE_STRING       (vid_scalefilter,                                   NOVALUEALIAS       ),
     CONFIG_VARIABLE_OTHER        (vid_screenresolution,                              NOVALUEALIAS       ),
@@ -819,9 +823,13 @@ static void M_CheckCVARs(void)
     if (r_skycolor != r_skycolor_none && (r_skycolor < r_skycolor_min || r_skycolor > r_skycolor_max))
         r_skycolor = r_skycolor_default;
 
+    r_texturecache = BETWEEN(r_texturecache_min, r_texturecache, r_texturecache_max);
+
     if (r_textures != false && r_textures != true)
         r_textures = r_textures_default;
 
+    r_threads = BETWEEN(r_threads_min, r_threads, r_threads_max);
+
     if (r_translucency != false && r_translucency != true)
         r_translucency = r_translucency_default;
 
@@ -842,6 +850,9 @@ static void M_CheckCVARs(void)
     if (s_stereo != false && s_stereo != true)
         s_stereo = s_stereo_default;
 
+    if (savecompression != false && savecompression != true)
+        savecompression = savecompression_default;
+
     savegame = BETWEEN(savegame_min, savegame, savegame_max);
 
     skilllevel = BETWEEN(skilllevel_min, skilllevel, skilllevel_max);
@@ -873,6 +884,9 @@ static void M_CheckCVARs(void)
     if (vid_pillarboxes != false && vid_pillarboxes != true)
         vid_pillarboxes = vid_pillarboxes_default;
 
+    if (vid_pipeline != false && vid_pipeline != true)
+        vid_pipeline = vid_pipeline_default;
+
     if (!M_StringCompare(vid_scaleapi, vid_scaleapi_software)
 #if defined(_WIN32)
         && !M_StringCompare(vid_scaleapi, vid_scaleapi_direct3d)
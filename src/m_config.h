@@ -139,7 +139,9 @@ extern dboolean     r_shadows_translucency;
 extern dboolean     r_shake_barrels;
 extern int          r_shake_damage;
 extern int          r_skycolor;
+extern int          r_texturecache;
 extern dboolean     r_textures;
+extern int          r_threads;
 extern dboolean     r_translucency;
 extern int          s_channels;
 extern int          s_musicvolume;
@@ -147,6 +149,7 @@ extern dboolean     s_randommusic;
 extern dboolean     s_randompitch;
 extern int          s_sfxvolume;
 extern dboolean     s_stereo;
+extern dboolean     savecompression;
 extern int          savegame;
 extern int          skilllevel;
 extern unsigned int stat_barrelsexploded;
@@ -207,6 +210,7 @@ extern char         *vid_driver;
 extern dboolean     vid_fullscreen;
 extern int          vid_motionblur;
 extern dboolean     vid_pillarboxes;
+extern dboolean     vid_pipeline;
 extern char         *vid_scaleapi;
 extern char         *vid_scalefilter;
 extern char         *vid_screenresolution;
@@ -562,8 +566,16 @@ enum
 #define r_skycolor_default                      r_skycolor_none
 #define r_skycolor_max                          255
 
+#define r_texturecache_min                      16
+#define r_texturecache_default                  256
+#define r_texturecache_max                      4096
+
 #define r_textures_default                      true
 
+#define r_threads_min                           1
+#define r_threads_default                       1
+#define r_threads_max                           8
+
 #define r_translucency_default                  true
 
 #define s_channels_min                          8
@@ -584,6 +596,8 @@ enum
 
 #define s_stereo_default                        true
 
+#define savecompression_default                 false
+
 #define savegame_min                            1
 #define savegame_default                        1
 #define savegame_max                            6
@@ -628,6 +642,8 @@ enum
 
 #define vid_pillarboxes_default                 false
 
+#define vid_pipeline_default                    false
+
 #if defined(_WIN32)
 #define vid_scaleapi_direct3d                   "direct3d"
 #elif defined(__APPLE__)
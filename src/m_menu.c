@@ -457,44 +457,44 @@ menu_t SaveDef =
     load1
 };
 
-static int blurheight;
-
-static void BlurScreen(byte *screen, byte *blurscreen, int height)
+//
+// BlurScreen
+//  darken and blur screen into blurscreen, but only if it has changed since it was last done
+//
+static void BlurScreen(byte *screen, byte *blurscreen, byte *sourcescreen, int height, int *blurheight)
 {
-    for (int i = 0; i < height; i++)
-        blurscreen[i] = grays[screen[i]];
+    static byte     noise[SCREENWIDTH * SCREENHEIGHT];
+    static dboolean noisegenerated;
 
-    for (int y = 0; y <= height - SCREENWIDTH; y += SCREENWIDTH)
-        for (int x = y; x <= y + SCREENWIDTH - 2; x++)
-            blurscreen[x] = tinttab50[(blurscreen[x + 1] << 8) + blurscreen[x]];
+    if (height == *blurheight && !memcmp(sourcescreen, screen, height))
+        return;
 
-    for (int y = 0; y <= height - SCREENWIDTH; y += SCREENWIDTH)
-        for (int x = y + SCREENWIDTH - 2; x >= y; x--)
-            blurscreen[x] = tinttab50[(blurscreen[x - 1] << 8) + blurscreen[x]];
+    memcpy(sourcescreen, screen, height);
+    *blurheight = height;
 
-    for (int y = 0; y <= height - SCREENWIDTH * 2; y += SCREENWIDTH)
-        for (int x = y; x <= y + SCREENWIDTH - 2; x++)
-            blurscreen[x] = tinttab50[(blurscreen[x + SCREENWIDTH + 1] << 8) + blurscreen[x]];
+    if (!noisegenerated)
+    {
+        for (int i = 0; i < SCREENWIDTH * SCREENHEIGHT; i++)
+            noise[i] = (M_CosmeticRandom() & 7);
 
-    for (int y = height - SCREENWIDTH; y >= SCREENWIDTH; y -= SCREENWIDTH)
-        for (int x = y + SCREENWIDTH - 1; x >= y + 1; x--)
-            blurscreen[x] = tinttab50[(blurscreen[x - SCREENWIDTH - 1] << 8) + blurscreen[x]];
+        noisegenerated = true;
+    }
 
-    for (int y = 0; y <= height - SCREENWIDTH * 2; y += SCREENWIDTH)
-        for (int x = y; x <= y + SCREENWIDTH - 1; x++)
-            blurscreen[x] = tinttab50[(blurscreen[x + SCREENWIDTH] << 8) + blurscreen[x]];
+    for (int i = 0; i < height; i += SCREENWIDTH)
+    {
+        screen[i] = nearestblack;
+        screen[i + 1] = nearestblack;
+        screen[i + SCREENWIDTH - 2] = nearestblack;
+        screen[i + SCREENWIDTH - 1] = nearestblack;
+    }
 
-    for (int y = height - SCREENWIDTH; y >= SCREENWIDTH; y -= SCREENWIDTH)
-        for (int x = y; x <= y + SCREENWIDTH - 1; x++)
-            blurscreen[x] = tinttab50[(blurscreen[x - SCREENWIDTH] << 8) + blurscreen[x]];
+    for (int i = 0; i < height; i++)
+        screen[i] = grays[colormaps[0][(noise[i] << 8) + screen[i]]];
 
-    for (int y = 0; y <= height - SCREENWIDTH * 2; y += SCREENWIDTH)
-        for (int x = y + SCREENWIDTH - 1; x >= y + 1; x--)
-            blurscreen[x] = tinttab50[(blurscreen[x + SCREENWIDTH - 1] << 8) + blurscreen[x]];
+    V_BlurScreen(screen, blurscreen, height);
 
-    for (int y = height - SCREENWIDTH; y >= SCREENWIDTH; y -= SCREENWIDTH)
-        for (int x = y; x <= y + SCREENWIDTH - 2; x++)
-            blurscreen[x] = tinttab50[(blurscreen[x - SCREENWIDTH + 1] << 8) + blurscreen[x]];
+    for (int i = 0; i < height; i++)
+        blurscreen[i] = tinttab33[blurscreen[i]];
 }
 
 //
@@ -505,51 +505,24 @@ void M_DarkBackground(void)
 {
     static byte blurscreen1[SCREENWIDTH * SCREENHEIGHT];
     static byte blurscreen2[(SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH];
+    static byte sourcescreen1[SCREENWIDTH * SCREENHEIGHT];
+    static byte sourcescreen2[(SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH];
+    static int  blurheight1;
+    static int  blurheight2;
     static int  prevtic = -1;
-
-    blurheight = (SCREENHEIGHT - (vid_widescreen && gamestate == GS_LEVEL) * SBARHEIGHT) * SCREENWIDTH;
+    const int   height = (SCREENHEIGHT - (vid_widescreen && gamestate == GS_LEVEL) * SBARHEIGHT) * SCREENWIDTH;
 
     if (gametime != prevtic)
     {
-        for (int i = 0; i < blurheight; i += SCREENWIDTH)
-        {
-            screens[0][i] = nearestblack;
-            screens[0][i + 1] = nearestblack;
-            screens[0][i + SCREENWIDTH - 2] = nearestblack;
-            screens[0][i + SCREENWIDTH - 1] = nearestblack;
-        }
-
-        for (int i = 0; i < blurheight; i++)
-            screens[0][i] = colormaps[0][(M_Random() & 7) * 256 + screens[0][i]];
-
-        BlurScreen(screens[0], blurscreen1, blurheight);
-
-        for (int i = 0; i < blurheight; i++)
-            blurscreen1[i] = tinttab33[blurscreen1[i]];
+        BlurScreen(screens[0], blurscreen1, sourcescreen1, height, &blurheight1);
 
         if (mapwindow)
-        {
-            for (int i = 0; i < (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH; i += SCREENWIDTH)
-            {
-                mapscreen[i] = nearestblack;
-                mapscreen[i + 1] = nearestblack;
-                mapscreen[i + SCREENWIDTH - 2] = nearestblack;
-                mapscreen[i + SCREENWIDTH - 1] = nearestblack;
-            }
-
-            for (int i = 0; i < (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH; i++)
-                mapscreen[i] = colormaps[0][(M_Random() & 7) * 256 + mapscreen[i]];
-
-            BlurScreen(mapscreen, blurscreen2, (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH);
-
-            for (int i = 0; i < (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH; i++)
-                blurscreen2[i] = tinttab33[blurscreen2[i]];
-        }
+            BlurScreen(mapscreen, blurscreen2, sourcescreen2, (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH, &blurheight2);
 
         prevtic = gametime;
     }
 
-    memcpy(screens[0], blurscreen1, blurheight);
+    memcpy(screens[0], blurscreen1, height);
 
     if (mapwindow)
         memcpy(mapscreen, blurscreen2, (SCREENHEIGHT - SBARHEIGHT) * SCREENWIDTH);
@@ -817,6 +790,7 @@ static void M_ReadSaveStrings(void)
 {
     char    name[256];
 
+    P_WaitForSaveGame();
     savegames = false;
 
     for (int i = 0; i < load_end; i++)
@@ -864,11 +838,13 @@ static byte saveg_read8(FILE *file)
 //
 static dboolean M_CheckSaveGame(void)
 {
-    FILE    *file = fopen(P_SaveGameFile(itemOn), "rb");
+    FILE    *file;
     int     ep;
     int     mission;
 
-    if (!file)
+    P_WaitForSaveGame();
+
+    if (!(file = fopen(P_SaveGameFile(itemOn), "rb")))
         return true;
 
     for (int i = 0; i < SAVESTRINGSIZE + VERSIONSIZE + 1; i++)
@@ -1373,6 +1349,7 @@ static void M_DeleteSavegameResponse(int key)
         char        *temp;
 
         M_StringCopy(buffer, P_SaveGameFile(itemOn), sizeof(buffer));
+        P_WaitForSaveGame();
 
         if (remove(buffer) == -1)
         {
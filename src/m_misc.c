@@ -877,3 +877,15 @@ void M_StripQuotes(char *string)
         string[len] = '\0';
     }
 }
+
+//
+// M_Hash
+// Continues an FNV-1a hash of some data. Start with a hash of FNVOFFSETBASIS.
+//
+uint64_t M_Hash(uint64_t hash, const void *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ ((const byte *)data)[i]) * 1099511628211ULL;
+
+    return hash;
+}
@@ -100,4 +100,8 @@ void strreplace(char *target, char *needle, const char *replacement);
 int hextodec(char *hex);
 void M_StripQuotes(char *string);
 
+#define FNVOFFSETBASIS  14695981039346656037ULL
+
+uint64_t M_Hash(uint64_t hash, const void *data, size_t size);
+
 #endif
@@ -36,7 +36,17 @@
 ========================================================================
 */
 
-static unsigned int seed;
+#include "doomtype.h"
+
+//
+// Gameplay and cosmetic random numbers
+// Anything that affects the game uses M_Random() and friends, which only advance once per
+// call from the game's tickers, so the game plays out the same however many frames are drawn.
+// Effects that are only drawn, like fuzz and screen shakes, use M_CosmeticRandom() instead,
+// which has a separate seed for every thread so render threads don't race each other.
+//
+static unsigned int             seed;
+static THREADLOCAL unsigned int cosmeticseed = 1;
 
 static unsigned int fastrand(void)
 {
@@ -71,3 +81,23 @@ void M_Seed(unsigned int value)
 {
     seed = value;
 }
+
+unsigned int M_GetSeed(void)
+{
+    return seed;
+}
+
+int M_CosmeticRandom(void)
+{
+    return (((cosmeticseed = 214013 * cosmeticseed + 2531011) >> 16) & 255);
+}
+
+int M_CosmeticRandomInt(int lower, int upper)
+{
+    return (((cosmeticseed = 214013 * cosmeticseed + 2531011) >> 16) % (upper - lower + 1) + lower);
+}
+
+void M_SeedCosmetic(unsigned int value)
+{
+    cosmeticseed = value;
+}
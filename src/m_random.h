@@ -44,5 +44,10 @@ int M_SubRandom(void);
 int M_RandomInt(int lower, int upper);
 int M_RandomIntNoRepeat(int lower, int upper, int previous);
 void M_Seed(unsigned int value);
+unsigned int M_GetSeed(void);
+
+int M_CosmeticRandom(void);
+int M_CosmeticRandomInt(int lower, int upper);
+void M_SeedCosmetic(unsigned int value);
 
 #endif
@@ -36,6 +36,8 @@
 ========================================================================
 */
 
+#include "SDL.h"
+
 #include "am_map.h"
 #include "c_console.h"
 #include "doomstat.h"
@@ -43,6 +45,7 @@
 #include "i_system.h"
 #include "m_config.h"
 #include "m_misc.h"
+#include "m_random.h"
 #include "p_local.h"
 #include "p_saveg.h"
 #include "p_tick.h"
@@ -50,10 +53,51 @@
 #include "version.h"
 #include "z_zone.h"
 
-#define SAVEGAME_EOF    0x1D
-#define TARGETLIMIT     4192
+#define SAVEGAME_EOF            0x1D
+#define TARGETLIMIT             4192
+
+// The last byte of the version string in the header is always 0, so it
+// is used to flag that the rest of the savegame after the header is
+// compressed.
+#define SAVEGAME_FLAGS          (SAVESTRINGSIZE + VERSIONSIZE - 1)
+#define SAVEGAME_COMPRESSED     1
+#define SAVEGAME_HEADERSIZE     (SAVESTRINGSIZE + VERSIONSIZE + 7)
+
+#define LZ_MINMATCH             4
+#define LZ_MAXOFFSET            65535
+#define LZ_HASHBITS             14
 
-FILE        *save_stream;
+typedef struct
+{
+    FILE        *file;
+    byte        *buffer;
+    size_t      length;
+    dboolean    compress;
+    char        *tempfile;
+    char        *savefile;
+    dboolean    failed;
+} savegamewrite_t;
+
+dboolean        savecompression = savecompression_default;
+
+static FILE     *save_stream;
+
+// The whole savegame is read into or written to this buffer in one go.
+static byte     *savebuffer;
+static size_t   savebuffersize;
+static size_t   savebufferlength;
+static size_t   savebufferpos;
+static size_t   lastsavelength;
+
+// Things are numbered for savegames using these tables.
+static mobj_t   **thingtable;
+static int      *thinghash;
+static int      numthingtable;
+static int      thinghashsize;
+static dboolean thingsindexed;
+
+static SDL_Thread       *savethread;
+static savegamewrite_t  savewrite;
 
 static int  thingindex;
 static int  targets[TARGETLIMIT];
@@ -94,19 +138,360 @@ char *P_SaveGameFile(int slot)
     return filename;
 }
 
-// Endian-safe integer read/write functions
-static byte saveg_read8(void)
+//
+// LZ compression
+// A simple LZ77 compressor along the lines of LZ4. Each run of literals is followed by a
+// match of at least LZ_MINMATCH bytes earlier in the data, preceded by a token that has
+// the number of literals in its high nibble and the length of the match in its low nibble,
+// with lengths of 15 or more continued in following bytes. The last token has no match.
+//
+static size_t saveg_compressbound(size_t length)
 {
-    byte    result = -1;
+    return (length + length / 255 + 16);
+}
 
-    fread(&result, 1, 1, save_stream);
+static unsigned int saveg_lzhash(const byte *source)
+{
+    return (((source[0] | (source[1] << 8) | (source[2] << 16) | ((unsigned int)source[3] << 24))
+        * 2654435761u) >> (32 - LZ_HASHBITS));
+}
 
-    return result;
+static size_t saveg_writelzlength(byte *dest, size_t out, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        dest[out++] = 255;
+
+    dest[out++] = (byte)length;
+
+    return out;
+}
+
+static size_t saveg_writelztoken(byte *dest, size_t out, const byte *literals, size_t numliterals,
+    size_t offset, size_t matchlength)
+{
+    const size_t    match = (matchlength ? matchlength - LZ_MINMATCH : 0);
+
+    dest[out++] = (byte)((MIN(numliterals, 15) << 4) | MIN(match, 15));
+
+    if (numliterals >= 15)
+        out = saveg_writelzlength(dest, out, numliterals - 15);
+
+    memcpy(dest + out, literals, numliterals);
+    out += numliterals;
+
+    if (matchlength)
+    {
+        dest[out++] = (offset & 0xFF);
+        dest[out++] = ((offset >> 8) & 0xFF);
+
+        if (match >= 15)
+            out = saveg_writelzlength(dest, out, match - 15);
+    }
+
+    return out;
+}
+
+static size_t saveg_compress(const byte *source, size_t length, byte *dest)
+{
+    size_t  *table = calloc((size_t)1 << LZ_HASHBITS, sizeof(*table));
+    size_t  anchor = 0;
+    size_t  pos = 0;
+    size_t  out = 0;
+
+    while (pos + LZ_MINMATCH <= length)
+    {
+        const unsigned int  hash = saveg_lzhash(source + pos);
+        const size_t        candidate = table[hash];
+
+        table[hash] = pos + 1;
+
+        if (candidate && pos - (candidate - 1) <= LZ_MAXOFFSET
+            && !memcmp(source + candidate - 1, source + pos, LZ_MINMATCH))
+        {
+            const size_t    match = candidate - 1;
+            size_t          matchlength = LZ_MINMATCH;
+
+            while (pos + matchlength < length && source[match + matchlength] == source[pos + matchlength])
+                matchlength++;
+
+            out = saveg_writelztoken(dest, out, source + anchor, pos - anchor, pos - match, matchlength);
+            pos += matchlength;
+            anchor = pos;
+        }
+        else
+            pos++;
+    }
+
+    out = saveg_writelztoken(dest, out, source + anchor, length - anchor, 0, 0);
+    free(table);
+
+    return out;
+}
+
+static dboolean saveg_readlzlength(const byte *source, size_t length, size_t *in, size_t *result)
+{
+    byte    b;
+
+    do
+    {
+        if (*in >= length)
+            return false;
+
+        b = source[(*in)++];
+        *result += b;
+    } while (b == 255);
+
+    return true;
+}
+
+static dboolean saveg_decompress(const byte *source, size_t length, byte *dest, size_t destlength)
+{
+    size_t  in = 0;
+    size_t  out = 0;
+
+    while (in < length)
+    {
+        const byte  token = source[in++];
+        size_t      numliterals = (token >> 4);
+        size_t      matchlength = (token & 0x0F);
+        size_t      offset;
+
+        if (numliterals == 15 && !saveg_readlzlength(source, length, &in, &numliterals))
+            return false;
+
+        if (numliterals > length - in || numliterals > destlength - out)
+            return false;
+
+        memcpy(dest + out, source + in, numliterals);
+        in += numliterals;
+        out += numliterals;
+
+        // the last token has no match
+        if (in == length)
+            break;
+
+        if (length - in < 2)
+            return false;
+
+        offset = source[in] | (source[in + 1] << 8);
+        in += 2;
+
+        if (matchlength == 15 && !saveg_readlzlength(source, length, &in, &matchlength))
+            return false;
+
+        matchlength += LZ_MINMATCH;
+
+        if (!offset || offset > out || matchlength > destlength - out)
+            return false;
+
+        // copy a byte at a time since the match can overlap what is being copied
+        for (size_t i = 0; i < matchlength; i++, out++)
+            dest[out] = dest[out - offset];
+    }
+
+    return (out == destlength);
+}
+
+//
+// P_OpenSaveGame
+// Read the whole of a savegame into memory, decompressing it if it was
+// compressed. Returns false if it couldn't be read.
+//
+dboolean P_OpenSaveGame(char *filename)
+{
+    FILE    *file;
+    long    length;
+
+    P_WaitForSaveGame();
+
+    if (!(file = fopen(filename, "rb")))
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (length < 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    free(savebuffer);
+    savebuffersize = MAX(length, 1);
+    savebuffer = malloc(savebuffersize);
+    savebufferlength = fread(savebuffer, 1, length, file);
+    savebufferpos = 0;
+    thingsindexed = false;
+    fclose(file);
+
+    if (savebufferlength > SAVEGAME_HEADERSIZE + 4 && (savebuffer[SAVEGAME_FLAGS] & SAVEGAME_COMPRESSED))
+    {
+        const byte      *body = savebuffer + SAVEGAME_HEADERSIZE;
+        const size_t    bodylength = body[0] | (body[1] << 8) | (body[2] << 16) | ((size_t)body[3] << 24);
+        byte            *buffer = malloc(SAVEGAME_HEADERSIZE + MAX(bodylength, 1));
+
+        memcpy(buffer, savebuffer, SAVEGAME_HEADERSIZE);
+        buffer[SAVEGAME_FLAGS] = 0;
+
+        if (!saveg_decompress(body + 4, savebufferlength - SAVEGAME_HEADERSIZE - 4, buffer + SAVEGAME_HEADERSIZE, bodylength))
+        {
+            free(buffer);
+            P_CloseSaveGame();
+            return false;
+        }
+
+        free(savebuffer);
+        savebuffer = buffer;
+        savebuffersize = savebufferlength = SAVEGAME_HEADERSIZE + bodylength;
+    }
+
+    return true;
+}
+
+void P_CloseSaveGame(void)
+{
+    thingsindexed = false;
+    free(savebuffer);
+    savebuffer = NULL;
+    savebuffersize = 0;
+    savebufferlength = 0;
+    savebufferpos = 0;
+}
+
+//
+// P_CreateSaveGame
+// Open a file to write a savegame to, which is first built up in memory.
+// Returns false if the file couldn't be opened.
+//
+dboolean P_CreateSaveGame(char *filename)
+{
+    P_WaitForSaveGame();
+
+    if (!(save_stream = fopen(filename, "wb")))
+        return false;
+
+    // start with a buffer big enough for the last savegame so it doesn't need to grow
+    P_CloseSaveGame();
+    savebuffersize = MAX(lastsavelength, 65536);
+    savebuffer = malloc(savebuffersize);
+
+    return true;
+}
+
+static int SDLCALL P_SaveGameThread(void *data)
+{
+    savegamewrite_t *savegame = data;
+    byte            *buffer = savegame->buffer;
+    size_t          length = savegame->length;
+    char            *backupfile;
+
+    if (savegame->compress && length > SAVEGAME_HEADERSIZE)
+    {
+        const size_t    bodylength = length - SAVEGAME_HEADERSIZE;
+        byte            *compressed = malloc(SAVEGAME_HEADERSIZE + 4 + saveg_compressbound(bodylength));
+        byte            *body = compressed + SAVEGAME_HEADERSIZE;
+
+        memcpy(compressed, buffer, SAVEGAME_HEADERSIZE);
+        compressed[SAVEGAME_FLAGS] |= SAVEGAME_COMPRESSED;
+        body[0] = (bodylength & 0xFF);
+        body[1] = ((bodylength >> 8) & 0xFF);
+        body[2] = ((bodylength >> 16) & 0xFF);
+        body[3] = ((bodylength >> 24) & 0xFF);
+        length = SAVEGAME_HEADERSIZE + 4 + saveg_compress(buffer + SAVEGAME_HEADERSIZE, bodylength, body + 4);
+
+        free(buffer);
+        buffer = compressed;
+    }
+
+    savegame->failed = (fwrite(buffer, 1, length, savegame->file) != length);
+    savegame->failed |= (fclose(savegame->file) != 0);
+    free(buffer);
+
+    if (savegame->failed)
+    {
+        remove(savegame->tempfile);
+        return 0;
+    }
+
+    // Now rename the temporary savegame file to the actual savegame
+    // file, backing up the old savegame if there was one there.
+    backupfile = M_StringJoin(savegame->savefile, ".bak", NULL);
+    remove(backupfile);
+    rename(savegame->savefile, backupfile);
+    rename(savegame->tempfile, savegame->savefile);
+    free(backupfile);
+
+    return 0;
+}
+
+//
+// P_WriteSaveGame
+// Write the savegame built up in memory to the file opened by P_CreateSaveGame() in the
+// background, then replace the savegame in filename with it once it has been written.
+//
+void P_WriteSaveGame(char *filename)
+{
+    lastsavelength = savebufferlength;
+
+    savewrite.file = save_stream;
+    savewrite.buffer = savebuffer;
+    savewrite.length = savebufferlength;
+    savewrite.compress = savecompression;
+    savewrite.tempfile = M_StringDuplicate(P_TempSaveGameFile());
+    savewrite.savefile = M_StringDuplicate(filename);
+    savewrite.failed = false;
+
+    save_stream = NULL;
+    savebuffer = NULL;
+    P_CloseSaveGame();
+
+    if (!(savethread = SDL_CreateThread(&P_SaveGameThread, "P_SaveGameThread", &savewrite)))
+    {
+        P_SaveGameThread(&savewrite);
+        P_WaitForSaveGame();
+    }
+}
+
+//
+// P_WaitForSaveGame
+// Wait for a savegame that is being written in the background to finish.
+//
+void P_WaitForSaveGame(void)
+{
+    if (savethread)
+    {
+        SDL_WaitThread(savethread, NULL);
+        savethread = NULL;
+    }
+
+    if (savewrite.savefile)
+    {
+        if (savewrite.failed)
+            C_Warning(1, "<b>%s</b> couldn't be saved.", savewrite.savefile);
+
+        free(savewrite.tempfile);
+        free(savewrite.savefile);
+        savewrite.tempfile = NULL;
+        savewrite.savefile = NULL;
+    }
+}
+
+// Endian-safe integer read/write functions
+static byte saveg_read8(void)
+{
+    return (savebufferpos < savebufferlength ? savebuffer[savebufferpos++] : 0xFF);
 }
 
 static void saveg_write8(byte value)
 {
-    fwrite(&value, 1, 1, save_stream);
+    if (savebufferlength == savebuffersize)
+    {
+        savebuffersize *= 2;
+        savebuffer = I_Realloc(savebuffer, savebuffersize);
+    }
+
+    savebuffer[savebufferlength++] = value;
 }
 
 static short saveg_read16(void)
@@ -177,36 +562,83 @@ static void saveg_write_mapthing_t(mapthing_t *str)
     saveg_write16(str->options);
 }
 
-static int P_ThingToIndex(mobj_t *thing)
+//
+// Thing indices
+// Things are referred to in savegames by their position in the list of mobj thinkers.
+// Rather than walk the list each time a thing is looked up, all of them are numbered
+// the first time one is needed while a savegame is being written or read, using a table
+// of things in order and a hash table from each thing back to its index.
+//
+static unsigned int P_HashThing(const mobj_t *thing)
 {
-    int i = 0;
+    const uintptr_t key = (uintptr_t)thing / sizeof(void *);
 
-    if (!thing)
-        return 0;
+    return (unsigned int)((key ^ (key >> 16)) * 2654435761u) & (thinghashsize - 1);
+}
+
+static void P_IndexThings(void)
+{
+    int count = 0;
+
+    for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
+        count++;
+
+    if (count > numthingtable)
+        thingtable = I_Realloc(thingtable, count * sizeof(*thingtable));
+
+    numthingtable = count;
+
+    if (count * 2 > thinghashsize)
+    {
+        while (count * 2 > thinghashsize)
+            thinghashsize = MAX(thinghashsize * 2, 256);
+
+        thinghash = I_Realloc(thinghash, thinghashsize * sizeof(*thinghash));
+    }
+
+    memset(thinghash, 0, thinghashsize * sizeof(*thinghash));
+    count = 0;
 
     for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
     {
-        i++;
+        unsigned int    i = P_HashThing((mobj_t *)th);
 
-        if ((mobj_t *)th == thing)
-            return i;
+        while (thinghash[i])
+            i = (i + 1) & (thinghashsize - 1);
+
+        thingtable[count] = (mobj_t *)th;
+        thinghash[i] = ++count;
     }
 
+    thingsindexed = true;
+}
+
+static int P_ThingToIndex(mobj_t *thing)
+{
+    int index;
+
+    if (!thing)
+        return 0;
+
+    if (!thingsindexed)
+        P_IndexThings();
+
+    for (unsigned int i = P_HashThing(thing); (index = thinghash[i]); i = (i + 1) & (thinghashsize - 1))
+        if (thingtable[index - 1] == thing)
+            return index;
+
     return 0;
 }
 
 static mobj_t *P_IndexToThing(int index)
 {
-    int i = 0;
-
     if (!index)
         return NULL;
 
-    for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
-        if (++i == index)
-            return (mobj_t *)th;
+    if (!thingsindexed)
+        P_IndexThings();
 
-    return NULL;
+    return (index > 0 && index <= numthingtable ? thingtable[index - 1] : NULL);
 }
 
 //
@@ -1020,18 +1452,26 @@ dboolean P_ReadSaveGameHeader(char *description)
 
 //
 // Read the end of file marker. Returns true if read successfully.
+// The gameplay random seed follows it, so savegames without it still load.
 //
 dboolean P_ReadSaveGameEOF(void)
 {
-    return (saveg_read8() == SAVEGAME_EOF);
+    if (saveg_read8() != SAVEGAME_EOF)
+        return false;
+
+    if (savebufferpos + 4 <= savebufferlength)
+        M_Seed((unsigned int)saveg_read32());
+
+    return true;
 }
 
 //
-// Write the end of file marker
+// Write the end of file marker, followed by the gameplay random seed
 //
 void P_WriteSaveGameEOF(void)
 {
     saveg_write8(SAVEGAME_EOF);
+    saveg_write32((int)M_GetSeed());
 }
 
 //
@@ -74,6 +74,13 @@ char *P_TempSaveGameFile(void);
 // filename to use for a savegame slot
 char *P_SaveGameFile(int slot);
 
+// Savegame file open/write functions
+dboolean P_OpenSaveGame(char *filename);
+void P_CloseSaveGame(void);
+dboolean P_CreateSaveGame(char *filename);
+void P_WriteSaveGame(char *filename);
+void P_WaitForSaveGame(void);
+
 // Savegame file header read/write functions
 dboolean P_ReadSaveGameHeader(char *description);
 void P_WriteSaveGameHeader(char *description);
@@ -98,6 +105,4 @@ void P_UnArchiveMap(void);
 void P_RestoreTargets(void);
 void P_RemoveCorruptMobjs(void);
 
-extern FILE *save_stream;
-
 #endif
@@ -38,6 +38,8 @@
 
 #include <ctype.h>
 
+#include "SDL.h"
+
 #include "am_map.h"
 #include "c_console.h"
 #include "d_deh.h"
@@ -56,6 +58,7 @@
 #include "p_tick.h"
 #include "s_sound.h"
 #include "sc_man.h"
+#include "version.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -245,6 +248,11 @@ mapformat_t     mapformat;
 dboolean        boomcompatible;
 dboolean        mbfcompatible;
 dboolean        blockmaprebuilt;
+
+static SDL_Thread *blockmapthread;
+static uint64_t blockmaphash;
+static int      blockmapcount;
+
 dboolean        nojump = false;
 dboolean        nomouselook = false;
 
@@ -557,6 +565,25 @@ static fixed_t GetOffset(vertex_t *v1, vertex_t *v2)
     return ((fixed_t)(sqrt((double)dx * dx + (double)dy * dy)) << FRACBITS);
 }
 
+//
+// Map caches
+// Data that is slow to build for a map is saved to a file in a folder in the app data folder,
+// named after an FNV-1a hash of the data it was built from.
+//
+static char *P_CacheFile(const char *foldername, uint64_t hash)
+{
+    char    *appdatafolder = M_GetAppDataFolder();
+    char    *folder = M_StringJoin(appdatafolder, DIR_SEPARATOR_S, foldername, NULL);
+    char    *filename = malloc(strlen(folder) + 32);
+
+    M_MakeDirectory(appdatafolder);
+    M_MakeDirectory(folder);
+    sprintf(filename, "%s" DIR_SEPARATOR_S "%016llx.cache", folder, (unsigned long long)hash);
+    free(folder);
+
+    return filename;
+}
+
 // e6y: Smart malloc
 // Used by P_SetupLevel() for smart data loading
 // Do nothing if level is the same
@@ -1495,9 +1522,8 @@ static void P_LoadZSegs(const byte *data)
     }
 }
 
-static void P_LoadZNodes(int lump)
+static void P_LoadZNodesData(const byte *data)
 {
-    byte            *data = W_CacheLumpNum(lump);
     unsigned int    orgVerts;
     unsigned int    newVerts;
     unsigned int    numSubs;
@@ -1616,9 +1642,656 @@ static void P_LoadZNodes(int lump)
         }
     }
 
+    P_CheckLinedefs();
+}
+
+static void P_LoadZNodes(int lump)
+{
+    P_LoadZNodesData(W_CacheLumpNum(lump));
     W_ReleaseLumpNum(lump);
+}
 
-    P_CheckLinedefs();
+//
+// Node builder
+// Builds the nodes of a map with missing or broken nodes from its linedefs, partitioning
+// each set of segs along the linedef that splits the fewest segs while keeping both sides
+// balanced. The nodes are built in the same format as an uncompressed ZDoom XNOD lump so
+// P_LoadZNodesData() can load them, and are cached in the nodes folder so they are only
+// built once.
+//
+#define NODESCACHEID            PACKAGE_NAME " nodes 1"
+#define NODESCACHEIDSIZE        32
+#define NODESCACHEHEADER        (NODESCACHEIDSIZE + sizeof(uint64_t))
+
+#define NODEBUILDEREPSILON      (1.0 / 16.0)
+#define NODEBUILDERSPLITCOST    8
+#define NODEBUILDERCANDIDATES   64
+#define NODEBUILDERMAXDEPTH     1024
+#define NODEBUILDERTHREADDEPTH  2
+
+typedef struct bvertex_s
+{
+    fixed_t             x, y;
+    int                 index;
+    struct bvertex_s    *next;
+} bvertex_t;
+
+typedef struct
+{
+    bvertex_t           *v1, *v2;
+    int                 linedef;
+    int                 side;
+} bseg_t;
+
+typedef struct
+{
+    int                 x, y;
+    int                 dx, dy;
+    double              length;
+} partition_t;
+
+typedef struct bnode_s
+{
+    partition_t         partition;
+    short               bbox[2][4];
+    struct bnode_s      *children[2];
+
+    // subsector
+    bseg_t              *segs;
+    int                 numsegs;
+
+    // vertices created when splitting segs along the partition
+    bvertex_t           *newvertices;
+} bnode_t;
+
+typedef struct
+{
+    bseg_t              *segs;
+    int                 numsegs;
+    int                 depth;
+    bnode_t             *node;
+} nodebuilderjob_t;
+
+typedef struct
+{
+    byte                *subsectors;
+    byte                *segs;
+    byte                *nodes;
+    unsigned int        numsubsectors;
+    unsigned int        numsegs;
+    unsigned int        numnodes;
+} nodewriter_t;
+
+enum
+{
+    SEG_FRONT,
+    SEG_BACK,
+    SEG_SPLIT
+};
+
+static void P_GetPartition(const bseg_t *seg, partition_t *partition)
+{
+    const line_t    *line = lines + seg->linedef;
+    const vertex_t  *v1 = (seg->side ? line->v2 : line->v1);
+    const vertex_t  *v2 = (seg->side ? line->v1 : line->v2);
+
+    partition->x = v1->x >> FRACBITS;
+    partition->y = v1->y >> FRACBITS;
+    partition->dx = (v2->x >> FRACBITS) - partition->x;
+    partition->dy = (v2->y >> FRACBITS) - partition->y;
+
+    // node deltas are stored as shorts
+    while (partition->dx < SHRT_MIN || partition->dx > SHRT_MAX || partition->dy < SHRT_MIN || partition->dy > SHRT_MAX)
+    {
+        partition->dx /= 2;
+        partition->dy /= 2;
+    }
+
+    partition->length = sqrt((double)partition->dx * partition->dx + (double)partition->dy * partition->dy);
+}
+
+static double P_DistanceFromPartition(const bvertex_t *vertex, const partition_t *partition)
+{
+    double  distance = (((double)vertex->x / FRACUNIT - partition->x) * partition->dy
+                - ((double)vertex->y / FRACUNIT - partition->y) * partition->dx) / partition->length;
+
+    return (fabs(distance) < NODEBUILDEREPSILON ? 0.0 : distance);
+}
+
+// Returns which side of a partition a seg is on, the same way R_PointOnSide() does.
+static int P_ClassifySeg(const bseg_t *seg, const partition_t *partition, double *d1, double *d2)
+{
+    *d1 = P_DistanceFromPartition(seg->v1, partition);
+    *d2 = P_DistanceFromPartition(seg->v2, partition);
+
+    if (*d1 == 0.0 && *d2 == 0.0)
+        return ((double)(seg->v2->x - seg->v1->x) * partition->dx
+            + (double)(seg->v2->y - seg->v1->y) * partition->dy > 0.0 ? SEG_FRONT : SEG_BACK);
+    else if (*d1 >= 0.0 && *d2 >= 0.0)
+        return SEG_FRONT;
+    else if (*d1 <= 0.0 && *d2 <= 0.0)
+        return SEG_BACK;
+    else
+        return SEG_SPLIT;
+}
+
+static int P_PartitionCost(const bseg_t *segs, int numsegs, const partition_t *partition, int bestcost)
+{
+    int front = 0;
+    int back = 0;
+    int splits = 0;
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        double  d1, d2;
+
+        switch (P_ClassifySeg(segs + i, partition, &d1, &d2))
+        {
+            case SEG_FRONT:
+                front++;
+                break;
+
+            case SEG_BACK:
+                back++;
+                break;
+
+            default:
+                front++;
+                back++;
+
+                if (++splits * NODEBUILDERSPLITCOST >= bestcost)
+                    return INT_MAX;
+
+                break;
+        }
+    }
+
+    return (front && back ? splits * NODEBUILDERSPLITCOST + ABS(front - back) : INT_MAX);
+}
+
+// Try a sample of the segs' linedefs as partitions first, and only try them all if none
+// of those divide the segs. If none do, the segs are convex and form a subsector.
+static dboolean P_ChoosePartition(const bseg_t *segs, int numsegs, partition_t *best)
+{
+    const int   step = MAX(1, numsegs / NODEBUILDERCANDIDATES);
+    int         bestcost = INT_MAX;
+
+    for (int pass = (step > 1 ? 0 : 1); pass < 2 && bestcost == INT_MAX; pass++)
+        for (int i = 0; i < numsegs; i += (pass ? 1 : step))
+        {
+            partition_t partition;
+            int         cost;
+
+            // segs along the same linedef are next to each other and share a partition
+            if (pass && i && segs[i].linedef == segs[i - 1].linedef)
+                continue;
+
+            P_GetPartition(segs + i, &partition);
+
+            if ((cost = P_PartitionCost(segs, numsegs, &partition, bestcost)) < bestcost)
+            {
+                bestcost = cost;
+                *best = partition;
+            }
+        }
+
+    return (bestcost < INT_MAX);
+}
+
+static void P_GetSegsBBox(const bseg_t *segs, int numsegs, short *bbox)
+{
+    fixed_t box[4];
+
+    M_ClearBox(box);
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        M_AddToBox(box, segs[i].v1->x, segs[i].v1->y);
+        M_AddToBox(box, segs[i].v2->x, segs[i].v2->y);
+    }
+
+    bbox[BOXTOP] = (short)((box[BOXTOP] + FRACUNIT - 1) >> FRACBITS);
+    bbox[BOXBOTTOM] = (short)(box[BOXBOTTOM] >> FRACBITS);
+    bbox[BOXLEFT] = (short)(box[BOXLEFT] >> FRACBITS);
+    bbox[BOXRIGHT] = (short)((box[BOXRIGHT] + FRACUNIT - 1) >> FRACBITS);
+}
+
+static bnode_t *P_BuildNode(bseg_t *segs, int numsegs, int depth);
+
+static int SDLCALL P_BuildNodeThread(void *data)
+{
+    nodebuilderjob_t    *job = data;
+
+    job->node = P_BuildNode(job->segs, job->numsegs, job->depth);
+    return 0;
+}
+
+static bnode_t *P_BuildNode(bseg_t *segs, int numsegs, int depth)
+{
+    bnode_t             *node = calloc(1, sizeof(*node));
+    bseg_t              *sides[2];
+    int                 numsides[2] = { 0, 0 };
+    nodebuilderjob_t    job;
+    SDL_Thread          *thread = NULL;
+
+    if (depth >= NODEBUILDERMAXDEPTH || !P_ChoosePartition(segs, numsegs, &node->partition))
+    {
+        node->segs = segs;
+        node->numsegs = numsegs;
+        return node;
+    }
+
+    sides[0] = malloc(numsegs * sizeof(bseg_t));
+    sides[1] = malloc(numsegs * sizeof(bseg_t));
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        bseg_t      *seg = segs + i;
+        double      d1, d2;
+        const int   side = P_ClassifySeg(seg, &node->partition, &d1, &d2);
+
+        if (side != SEG_SPLIT)
+            sides[side][numsides[side]++] = *seg;
+        else
+        {
+            const double    t = d1 / (d1 - d2);
+            bvertex_t       *vertex = malloc(sizeof(*vertex));
+
+            vertex->x = (fixed_t)lround(seg->v1->x + t * ((double)seg->v2->x - seg->v1->x));
+            vertex->y = (fixed_t)lround(seg->v1->y + t * ((double)seg->v2->y - seg->v1->y));
+            vertex->index = -1;
+
+            if (vertex->x == seg->v1->x && vertex->y == seg->v1->y)
+            {
+                // split is too close to an end of the seg to make it any shorter
+                sides[d2 < 0.0][numsides[d2 < 0.0]++] = *seg;
+                free(vertex);
+            }
+            else if (vertex->x == seg->v2->x && vertex->y == seg->v2->y)
+            {
+                sides[d1 < 0.0][numsides[d1 < 0.0]++] = *seg;
+                free(vertex);
+            }
+            else
+            {
+                bseg_t  *part1 = sides[d1 < 0.0] + numsides[d1 < 0.0]++;
+                bseg_t  *part2 = sides[d2 < 0.0] + numsides[d2 < 0.0]++;
+
+                *part1 = *seg;
+                part1->v2 = vertex;
+                *part2 = *seg;
+                part2->v1 = vertex;
+
+                vertex->next = node->newvertices;
+                node->newvertices = vertex;
+            }
+        }
+    }
+
+    free(segs);
+
+    for (int i = 0; i < 2; i++)
+        P_GetSegsBBox(sides[i], numsides[i], node->bbox[i]);
+
+    // build the front of the top few nodes on their own threads
+    if (depth < NODEBUILDERTHREADDEPTH)
+    {
+        job.segs = sides[0];
+        job.numsegs = numsides[0];
+        job.depth = depth + 1;
+        thread = SDL_CreateThread(&P_BuildNodeThread, "P_BuildNodeThread", &job);
+    }
+
+    node->children[1] = P_BuildNode(sides[1], numsides[1], depth + 1);
+
+    if (thread)
+    {
+        SDL_WaitThread(thread, NULL);
+        node->children[0] = job.node;
+    }
+    else
+        node->children[0] = P_BuildNode(sides[0], numsides[0], depth + 1);
+
+    return node;
+}
+
+static void P_FreeNode(bnode_t *node)
+{
+    bvertex_t   *vertex = node->newvertices;
+
+    while (vertex)
+    {
+        bvertex_t   *next = vertex->next;
+
+        free(vertex);
+        vertex = next;
+    }
+
+    if (node->children[0])
+    {
+        P_FreeNode(node->children[0]);
+        P_FreeNode(node->children[1]);
+    }
+    else
+        free(node->segs);
+
+    free(node);
+}
+
+static int P_CountNewVertices(const bnode_t *node, bvertex_t **newvertices, int count)
+{
+    for (bvertex_t *vertex = node->newvertices; vertex; vertex = vertex->next)
+    {
+        if (newvertices)
+            newvertices[count] = vertex;
+
+        count++;
+    }
+
+    if (node->children[0])
+    {
+        count = P_CountNewVertices(node->children[0], newvertices, count);
+        count = P_CountNewVertices(node->children[1], newvertices, count);
+    }
+
+    return count;
+}
+
+static int P_CompareNewVertices(const void *a, const void *b)
+{
+    const bvertex_t *vertex1 = *(const bvertex_t **)a;
+    const bvertex_t *vertex2 = *(const bvertex_t **)b;
+
+    if (vertex1->x != vertex2->x)
+        return (vertex1->x < vertex2->x ? -1 : 1);
+
+    return (vertex1->y < vertex2->y ? -1 : (vertex1->y > vertex2->y));
+}
+
+static void P_CountNodes(const bnode_t *node, nodewriter_t *writer)
+{
+    if (!node->children[0])
+    {
+        writer->numsubsectors++;
+        writer->numsegs += node->numsegs;
+    }
+    else
+    {
+        P_CountNodes(node->children[0], writer);
+        P_CountNodes(node->children[1], writer);
+        writer->numnodes++;
+    }
+}
+
+// Nodes are written after their children, so the root node is the last one.
+static unsigned int P_WriteNode(const bnode_t *node, nodewriter_t *writer)
+{
+    if (!node->children[0])
+    {
+        const mapsubsector_znod_t   ms = { node->numsegs };
+
+        memcpy(writer->subsectors + writer->numsubsectors * sizeof(ms), &ms, sizeof(ms));
+
+        for (int i = 0; i < node->numsegs; i++)
+        {
+            const bseg_t    *seg = node->segs + i;
+            mapseg_znod_t   ms2;
+
+            ms2.v1 = seg->v1->index;
+            ms2.v2 = seg->v2->index;
+            ms2.linedef = (unsigned short)seg->linedef;
+            ms2.side = (unsigned char)seg->side;
+            memcpy(writer->segs + writer->numsegs++ * sizeof(ms2), &ms2, sizeof(ms2));
+        }
+
+        return (writer->numsubsectors++ | NF_SUBSECTOR);
+    }
+    else
+    {
+        mapnode_znod_t  mn;
+
+        mn.x = (short)node->partition.x;
+        mn.y = (short)node->partition.y;
+        mn.dx = (short)node->partition.dx;
+        mn.dy = (short)node->partition.dy;
+
+        for (int i = 0; i < 2; i++)
+        {
+            mn.children[i] = (int)P_WriteNode(node->children[i], writer);
+
+            for (int j = 0; j < 4; j++)
+                mn.bbox[i][j] = node->bbox[i][j];
+        }
+
+        memcpy(writer->nodes + writer->numnodes * sizeof(mn), &mn, sizeof(mn));
+        return writer->numnodes++;
+    }
+}
+
+static byte *P_BuildNodesData(size_t *size)
+{
+    bvertex_t       *orgvertices = malloc(numvertexes * sizeof(*orgvertices));
+    bseg_t          *bsegs = malloc(numlines * 2 * sizeof(*bsegs));
+    bvertex_t       **newvertices;
+    int             numbsegs = 0;
+    int             numnewvertices;
+    unsigned int    numnewvertices2 = 0;
+    bnode_t         *root;
+    nodewriter_t    writer = { NULL, NULL, NULL, 0, 0, 0 };
+    byte            *data;
+    byte            *p;
+
+    for (int i = 0; i < numvertexes; i++)
+    {
+        orgvertices[i].x = vertexes[i].x;
+        orgvertices[i].y = vertexes[i].y;
+        orgvertices[i].index = i;
+    }
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const line_t    *line = lines + i;
+
+        if (line->v1->x == line->v2->x && line->v1->y == line->v2->y)
+            continue;
+
+        for (int side = 0; side < 2; side++)
+            if (line->sidenum[side] != NO_INDEX)
+            {
+                bseg_t  *seg = bsegs + numbsegs++;
+
+                seg->v1 = orgvertices + ((side ? line->v2 : line->v1) - vertexes);
+                seg->v2 = orgvertices + ((side ? line->v1 : line->v2) - vertexes);
+                seg->linedef = i;
+                seg->side = side;
+            }
+    }
+
+    if (!numbsegs)
+        I_Error("This map has no linedefs.");
+
+    root = P_BuildNode(bsegs, numbsegs, 0);
+
+    // number the new vertices, giving those in the same place the same number
+    numnewvertices = P_CountNewVertices(root, NULL, 0);
+    newvertices = malloc(MAX(1, numnewvertices) * sizeof(*newvertices));
+    P_CountNewVertices(root, newvertices, 0);
+    qsort(newvertices, numnewvertices, sizeof(*newvertices), &P_CompareNewVertices);
+
+    for (int i = 0; i < numnewvertices; i++)
+        newvertices[i]->index = (i && !P_CompareNewVertices(newvertices + i - 1, newvertices + i) ?
+            newvertices[i - 1]->index : numvertexes + numnewvertices2++);
+
+    P_CountNodes(root, &writer);
+
+    *size = 4 + 2 * sizeof(unsigned int) + numnewvertices2 * 2 * sizeof(fixed_t)
+        + sizeof(unsigned int) + writer.numsubsectors * sizeof(mapsubsector_znod_t)
+        + sizeof(unsigned int) + writer.numsegs * sizeof(mapseg_znod_t)
+        + sizeof(unsigned int) + writer.numnodes * sizeof(mapnode_znod_t);
+    p = data = malloc(*size);
+
+    memcpy(p, "XNOD", 4);
+    p += 4;
+    memcpy(p, &numvertexes, sizeof(unsigned int));
+    p += sizeof(unsigned int);
+    memcpy(p, &numnewvertices2, sizeof(unsigned int));
+    p += sizeof(unsigned int);
+
+    for (int i = 0; i < numnewvertices; i++)
+        if (!i || newvertices[i]->index != newvertices[i - 1]->index)
+        {
+            memcpy(p, &newvertices[i]->x, sizeof(fixed_t));
+            p += sizeof(fixed_t);
+            memcpy(p, &newvertices[i]->y, sizeof(fixed_t));
+            p += sizeof(fixed_t);
+        }
+
+    memcpy(p, &writer.numsubsectors, sizeof(unsigned int));
+    writer.subsectors = p + sizeof(unsigned int);
+    p = writer.subsectors + writer.numsubsectors * sizeof(mapsubsector_znod_t);
+    memcpy(p, &writer.numsegs, sizeof(unsigned int));
+    writer.segs = p + sizeof(unsigned int);
+    p = writer.segs + writer.numsegs * sizeof(mapseg_znod_t);
+    memcpy(p, &writer.numnodes, sizeof(unsigned int));
+    writer.nodes = p + sizeof(unsigned int);
+
+    writer.numsubsectors = 0;
+    writer.numsegs = 0;
+    writer.numnodes = 0;
+    P_WriteNode(root, &writer);
+
+    P_FreeNode(root);
+    free(newvertices);
+    free(orgvertices);
+
+    return data;
+}
+
+static uint64_t P_HashNodesInput(void)
+{
+    uint64_t    hash = FNVOFFSETBASIS;
+
+    for (int i = 0; i < numvertexes; i++)
+    {
+        const fixed_t   coords[] = { vertexes[i].x, vertexes[i].y };
+
+        hash = M_Hash(hash, coords, sizeof(coords));
+    }
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const int   values[] =
+        {
+            (int)(lines[i].v1 - vertexes),
+            (int)(lines[i].v2 - vertexes),
+            (lines[i].sidenum[0] != NO_INDEX),
+            (lines[i].sidenum[1] != NO_INDEX)
+        };
+
+        hash = M_Hash(hash, values, sizeof(values));
+    }
+
+    return hash;
+}
+
+// Check that cached nodes are complete before P_LoadZNodesData() trusts them.
+static dboolean P_NodesDataIsValid(const byte *data, size_t size)
+{
+    size_t          offset = 4 + 2 * sizeof(unsigned int);
+    unsigned int    values[2];
+    unsigned int    count;
+
+    if (size < offset || memcmp(data, "XNOD", 4))
+        return false;
+
+    memcpy(values, data + 4, sizeof(values));
+
+    if (values[0] != (unsigned int)numvertexes)
+        return false;
+
+    offset += (size_t)values[1] * 2 * sizeof(fixed_t);
+
+    if (offset + sizeof(count) > size)
+        return false;
+
+    memcpy(&count, data + offset, sizeof(count));
+    offset += sizeof(count) + (size_t)count * sizeof(mapsubsector_znod_t);
+
+    if (offset + sizeof(count) > size)
+        return false;
+
+    memcpy(&count, data + offset, sizeof(count));
+    offset += sizeof(count) + (size_t)count * sizeof(mapseg_znod_t);
+
+    if (offset + sizeof(count) > size)
+        return false;
+
+    memcpy(&count, data + offset, sizeof(count));
+    offset += sizeof(count) + (size_t)count * sizeof(mapnode_znod_t);
+
+    return (offset == size);
+}
+
+static byte *P_LoadNodesCache(char *filename, uint64_t hash, size_t *size)
+{
+    wadfile_t   *file = W_OpenFile(filename);
+    byte        header[NODESCACHEHEADER];
+    byte        *data = NULL;
+
+    if (!file)
+        return NULL;
+
+    if (W_Read(file, 0, header, NODESCACHEHEADER) == NODESCACHEHEADER
+        && !strncmp((char *)header, NODESCACHEID, NODESCACHEIDSIZE)
+        && !memcmp(header + NODESCACHEIDSIZE, &hash, sizeof(hash))
+        && file->length > NODESCACHEHEADER)
+    {
+        *size = file->length - NODESCACHEHEADER;
+        data = malloc(*size);
+
+        if (W_Read(file, NODESCACHEHEADER, data, *size) != *size || !P_NodesDataIsValid(data, *size))
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    W_CloseFile(file);
+    return data;
+}
+
+static void P_SaveNodesCache(const char *filename, uint64_t hash, const byte *data, size_t size)
+{
+    byte    *buffer = malloc(NODESCACHEHEADER + size);
+
+    memset(buffer, 0, NODESCACHEIDSIZE);
+    M_StringCopy((char *)buffer, NODESCACHEID, NODESCACHEIDSIZE);
+    memcpy(buffer + NODESCACHEIDSIZE, &hash, sizeof(hash));
+    memcpy(buffer + NODESCACHEHEADER, data, size);
+    M_WriteFile(filename, buffer, (int)(NODESCACHEHEADER + size));
+
+    free(buffer);
+}
+
+static void P_BuildNodes(void)
+{
+    const uint64_t  hash = P_HashNodesInput();
+    char            *filename = P_CacheFile("nodes", hash);
+    size_t          size;
+    byte            *data = P_LoadNodesCache(filename, hash, &size);
+
+    C_Warning(1, "This map's nodes are missing or broken, so they have been rebuilt.");
+
+    if (!data)
+    {
+        data = P_BuildNodesData(&size);
+        P_SaveNodesCache(filename, hash, data, size);
+    }
+
+    P_LoadZNodesData(data);
+
+    free(data);
+    free(filename);
 }
 
 //
@@ -1972,6 +2645,14 @@ static dboolean P_VerifyBlockMap(int count)
             }
 
             offset = *blockoffset;
+
+            // check that the list starts in bounds
+            if (offset < 0 || offset >= count)
+            {
+                isvalid = false;
+                break;
+            }
+
             list = blockmaplump + offset;
 
             if (*list)
@@ -2167,6 +2848,7 @@ static void P_CreateBlockMap(void)
 
             // Allocate blockmap lump with computed count
             blockmaplump = malloc_IfSameLevel(blockmaplump, sizeof(*blockmaplump) * count);
+            blockmapcount = count;
         }
 
         // Now compress the blockmap.
@@ -2200,6 +2882,142 @@ static void P_CreateBlockMap(void)
     skipblstart = true;
 }
 
+//
+// Blockmap cache
+// Rebuilding a large map's blockmap can take a while, and must be done every time the map is
+// loaded if its BLOCKMAP lump is missing, invalid or too large. So once rebuilt, it is saved
+// to a file named after a hash of the only things it depends on: the position of each vertex,
+// and the vertices of each linedef. The next time the map is loaded, it is read from that
+// file instead. If there is no such file, the blockmap is rebuilt on another thread while the
+// map's nodes and segs are loaded, unless they are ZDoom extended nodes, which add vertices.
+//
+#define BLOCKMAPCACHEID     PACKAGE_NAME " blockmap 1"
+#define BLOCKMAPCACHEIDSIZE 32
+#define BLOCKMAPCACHEHEADER (BLOCKMAPCACHEIDSIZE + 8 * sizeof(int))
+
+static uint64_t P_HashBlockMapInput(void)
+{
+    uint64_t    hash = FNVOFFSETBASIS;
+
+    for (int i = 0; i < numvertexes; i++)
+    {
+        const int   coords[] = { vertexes[i].x >> FRACBITS, vertexes[i].y >> FRACBITS };
+
+        hash = M_Hash(hash, coords, sizeof(coords));
+    }
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const int   ends[] = { (int)(lines[i].v1 - vertexes), (int)(lines[i].v2 - vertexes) };
+
+        hash = M_Hash(hash, ends, sizeof(ends));
+    }
+
+    return hash;
+}
+
+static void P_BlockMapCacheHeader(byte *header)
+{
+    const int   values[8] = { numvertexes, numlines, blockmapcount, bmaporgx, bmaporgy, bmapwidth, bmapheight };
+
+    memset(header, 0, BLOCKMAPCACHEIDSIZE);
+    M_StringCopy((char *)header, BLOCKMAPCACHEID, BLOCKMAPCACHEIDSIZE);
+    memcpy(header + BLOCKMAPCACHEIDSIZE, values, sizeof(values));
+}
+
+static dboolean P_LoadBlockMapCache(void)
+{
+    char        *filename = P_CacheFile("blockmaps", blockmaphash);
+    wadfile_t   *file = W_OpenFile(filename);
+    byte        header[BLOCKMAPCACHEHEADER];
+    int         values[8];
+    dboolean    result = false;
+
+    free(filename);
+
+    if (!file)
+        return false;
+
+    if (W_Read(file, 0, header, BLOCKMAPCACHEHEADER) == BLOCKMAPCACHEHEADER
+        && !strncmp((char *)header, BLOCKMAPCACHEID, BLOCKMAPCACHEIDSIZE))
+    {
+        memcpy(values, header + BLOCKMAPCACHEIDSIZE, sizeof(values));
+
+        if (values[0] == numvertexes && values[1] == numlines && values[2] > 4)
+        {
+            const size_t    size = values[2] * sizeof(*blockmaplump);
+            void            *data = W_MappedData(file, BLOCKMAPCACHEHEADER, size);
+
+            blockmaplump = malloc_IfSameLevel(blockmaplump, size);
+
+            if (data)
+            {
+                memcpy(blockmaplump, data, size);
+                result = true;
+            }
+            else
+                result = (W_Read(file, BLOCKMAPCACHEHEADER, blockmaplump, size) == size);
+
+            if (result)
+            {
+                blockmapcount = values[2];
+                bmaporgx = values[3];
+                bmaporgy = values[4];
+                bmapwidth = values[5];
+                bmapheight = values[6];
+
+                // don't trust a cache file that is stale or corrupted
+                if (bmapwidth > 0 && bmapheight > 0 && (int64_t)bmapwidth * bmapheight + 4 <= blockmapcount
+                    && P_VerifyBlockMap(blockmapcount))
+                {
+                    blockmaprebuilt = true;
+                    skipblstart = true;
+                }
+                else
+                    result = false;
+            }
+        }
+    }
+
+    W_CloseFile(file);
+    return result;
+}
+
+static void P_SaveBlockMapCache(void)
+{
+    char    *filename = P_CacheFile("blockmaps", blockmaphash);
+    byte    *buffer = malloc(BLOCKMAPCACHEHEADER + blockmapcount * sizeof(*blockmaplump));
+
+    P_BlockMapCacheHeader(buffer);
+    memcpy(buffer + BLOCKMAPCACHEHEADER, blockmaplump, blockmapcount * sizeof(*blockmaplump));
+    M_WriteFile(filename, buffer, BLOCKMAPCACHEHEADER + blockmapcount * sizeof(*blockmaplump));
+
+    free(buffer);
+    free(filename);
+}
+
+static int SDLCALL P_CreateBlockMapThread(void *data)
+{
+    P_CreateBlockMap();
+    return 0;
+}
+
+static void P_RebuildBlockMap(void)
+{
+    blockmaphash = P_HashBlockMapInput();
+
+    if (P_LoadBlockMapCache())
+        return;
+
+    // nodes loaded or built in ZDoom format may add vertices, moving those the thread uses
+    if (mapformat != ZDBSPX && mapformat != BUILTNODES
+        && (blockmapthread = SDL_CreateThread(&P_CreateBlockMapThread, "P_CreateBlockMapThread", NULL)))
+        return;
+
+    P_CreateBlockMap();
+    P_SaveBlockMapCache();
+}
+
 //
 // P_LoadBlockMap
 //
@@ -2218,12 +3036,12 @@ static void P_LoadBlockMap(int lump)
 
     if (lump >= numlumps || (lumplen = W_LumpLength(lump)) < 8 || (count = lumplen / 2) >= 0x10000)
     {
-        P_CreateBlockMap();
+        P_RebuildBlockMap();
         C_Warning(2, "This map's <b>BLOCKMAP</b> lump was rebuilt.");
     }
     else if (M_CheckParm("-blockmap"))
     {
-        P_CreateBlockMap();
+        P_RebuildBlockMap();
         C_Warning(2, "A <b>-blockmap</b> parameter was found on the command-line. This map's <b>BLOCKMAP</b> lump was rebuilt.");
     }
     else
@@ -2257,10 +3075,25 @@ static void P_LoadBlockMap(int lump)
 
         if (!P_VerifyBlockMap(count))
         {
-            P_CreateBlockMap();
+            P_RebuildBlockMap();
             C_Warning(2, "This map's <b>BLOCKMAP</b> lump was rebuilt.");
         }
     }
+}
+
+//
+// P_FinishBlockMap
+// Wait for the blockmap to be rebuilt if P_LoadBlockMap() started doing so on another thread,
+// then set up everything else that depends on it.
+//
+static void P_FinishBlockMap(void)
+{
+    if (blockmapthread)
+    {
+        SDL_WaitThread(blockmapthread, NULL);
+        blockmapthread = NULL;
+        P_SaveBlockMapCache();
+    }
 
     // Clear out mobj chains
     blocklinks = calloc_IfSameLevel(blocklinks, (size_t)bmapwidth * bmapheight, sizeof(*blocklinks));
@@ -2711,6 +3544,67 @@ void P_MapName(int ep, int map)
     }
 }
 
+//
+// P_NodesAreValid
+// Check that the nodes, subsectors and segs of a map in the regular format are all there,
+// and only reference each other, vertices and linedefs that exist.
+//
+static dboolean P_NodesAreValid(int lumpnum)
+{
+    const int               vertexcount = W_LumpLength(lumpnum + ML_VERTEXES) / sizeof(mapvertex_t);
+    const int               linecount = W_LumpLength(lumpnum + ML_LINEDEFS) / sizeof(maplinedef_t);
+    const int               segslength = W_LumpLength(lumpnum + ML_SEGS);
+    const int               subsectorslength = W_LumpLength(lumpnum + ML_SSECTORS);
+    const int               nodeslength = W_LumpLength(lumpnum + ML_NODES);
+    const int               segcount = segslength / sizeof(mapseg_t);
+    const int               subsectorcount = subsectorslength / sizeof(mapsubsector_t);
+    const int               nodecount = nodeslength / sizeof(mapnode_t);
+    const mapseg_t          *ms;
+    const mapsubsector_t    *mss;
+    const mapnode_t         *mn;
+    dboolean                valid = true;
+
+    if (!segcount || !subsectorcount || (!nodecount && subsectorcount > 1)
+        || segslength % sizeof(mapseg_t) || subsectorslength % sizeof(mapsubsector_t) || nodeslength % sizeof(mapnode_t))
+        return false;
+
+    ms = W_CacheLumpNum(lumpnum + ML_SEGS);
+
+    for (int i = 0; i < segcount && valid; i++)
+        valid = ((unsigned short)SHORT(ms[i].v1) < vertexcount && (unsigned short)SHORT(ms[i].v2) < vertexcount
+            && (unsigned short)SHORT(ms[i].linedef) < linecount);
+
+    W_ReleaseLumpNum(lumpnum + ML_SEGS);
+
+    if (!valid)
+        return false;
+
+    mss = W_CacheLumpNum(lumpnum + ML_SSECTORS);
+
+    for (int i = 0; i < subsectorcount && valid; i++)
+        valid = ((unsigned short)SHORT(mss[i].numsegs) > 0
+            && (unsigned short)SHORT(mss[i].firstseg) + (unsigned short)SHORT(mss[i].numsegs) <= segcount);
+
+    W_ReleaseLumpNum(lumpnum + ML_SSECTORS);
+
+    if (!valid || !nodecount)
+        return valid;
+
+    mn = W_CacheLumpNum(lumpnum + ML_NODES);
+
+    for (int i = 0; i < nodecount && valid; i++)
+        for (int j = 0; j < 2 && valid; j++)
+        {
+            const unsigned short    child = (unsigned short)SHORT(mn[i].children[j]);
+
+            valid = ((child & 0x8000) ? (child & ~0x8000) < subsectorcount : child < nodecount);
+        }
+
+    W_ReleaseLumpNum(lumpnum + ML_NODES);
+
+    return valid;
+}
+
 static mapformat_t P_CheckMapFormat(int lumpnum)
 {
     mapformat_t format = DOOMBSP;
@@ -2732,6 +3626,9 @@ static mapformat_t P_CheckMapFormat(int lumpnum)
     if (n)
         W_ReleaseLumpNum(b);
 
+    if (format == DOOMBSP && !P_NodesAreValid(lumpnum))
+        format = BUILTNODES;
+
     return format;
 }
 
@@ -2855,11 +3752,11 @@ void P_SetupLevel(int ep, int map)
 
     if (!samelevel)
         P_LoadBlockMap(lumpnum + ML_BLOCKMAP);
-    else
-        memset(blocklinks, 0, (size_t)bmapwidth * bmapheight * sizeof(*blocklinks));
 
     if (mapformat == ZDBSPX)
         P_LoadZNodes(lumpnum + ML_NODES);
+    else if (mapformat == BUILTNODES)
+        P_BuildNodes();
     else if (mapformat == DEEPBSP)
     {
         P_LoadSubsectors_V4(lumpnum + ML_SSECTORS);
@@ -2873,6 +3770,11 @@ void P_SetupLevel(int ep, int map)
         P_LoadSegs(lumpnum + ML_SEGS);
     }
 
+    if (!samelevel)
+        P_FinishBlockMap();
+    else
+        memset(blocklinks, 0, (size_t)bmapwidth * bmapheight * sizeof(*blocklinks));
+
     P_GroupLines();
     P_LoadReject(lumpnum);
 
@@ -38,6 +38,7 @@
 
 #include "c_console.h"
 #include "doomstat.h"
+#include "i_timer.h"
 #include "p_local.h"
 #include "p_tick.h"
 #include "s_sound.h"
@@ -234,7 +235,9 @@ void P_Ticker(void)
         return;
     }
 
+    I_StartProfile(PROFILE_THINKERS);
     P_RunThinkers();
+    I_EndProfile(PROFILE_THINKERS);
 
     P_UpdateSpecials();
     P_RespawnSpecials();
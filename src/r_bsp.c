@@ -40,18 +40,26 @@
 #include <string.h>
 
 #include "doomstat.h"
+#include "i_system.h"
 #include "m_bbox.h"
 #include "r_main.h"
 #include "r_plane.h"
 #include "r_things.h"
 
-seg_t       *curline;
-line_t      *linedef;
-sector_t    *frontsector;
-sector_t    *backsector;
+THREADLOCAL seg_t      *curline;
+THREADLOCAL line_t     *linedef;
+THREADLOCAL sector_t   *frontsector;
+THREADLOCAL sector_t   *backsector;
 
-drawseg_t   *drawsegs;
-drawseg_t   *ds_p;
+THREADLOCAL drawseg_t  *drawsegs;
+THREADLOCAL drawseg_t  *ds_p;
+
+// sectors whose sprites have been added this frame, kept per thread
+// so strips rendered in parallel don't skip each other's sprites
+static THREADLOCAL int  *spritevalidcount;
+static THREADLOCAL int  numspritevalidcount;
+
+dboolean                sectorsinterpolated;
 
 void R_StoreWallRange(const int start, const int stop);
 
@@ -66,8 +74,8 @@ void R_ClearDrawSegs(void)
 // CPhipps -
 // Instead of clipsegs, let's try using an array with one entry for each column,
 // indicating whether it's blocked by a solid wall yet or not.
-static int  memcmpsize;
-byte        *solidcol;
+static int          memcmpsize;
+THREADLOCAL byte    solidcol[SCREENWIDTH];
 
 // CPhipps -
 // R_ClipWallSegment
@@ -110,15 +118,25 @@ void R_InitClipSegs(void)
         + sizeof(*frontsector->floorlightsec) + sizeof(*frontsector->ceilinglightsec)
         + sizeof(frontsector->floorpic) + sizeof(frontsector->ceilingpic)
         + sizeof(frontsector->lightlevel);
-    solidcol = calloc(1, SCREENWIDTH * sizeof(*solidcol));
 }
 
 //
 // R_ClearClipSegs
+// Columns outside of the strip being rendered are marked as solid
+// so nothing is drawn there.
 //
 void R_ClearClipSegs(void)
 {
-    memset(solidcol, 0, SCREENWIDTH);
+    memset(solidcol, 1, stripx1);
+    memset(solidcol + stripx1, 0, (size_t)stripx2 - stripx1 + 1);
+    memset(solidcol + stripx2 + 1, 1, (size_t)SCREENWIDTH - stripx2 - 1);
+
+    if (numspritevalidcount < numsectors)
+    {
+        spritevalidcount = I_Realloc(spritevalidcount, numsectors * sizeof(*spritevalidcount));
+        memset(spritevalidcount + numspritevalidcount, 0, ((size_t)numsectors - numspritevalidcount) * sizeof(*spritevalidcount));
+        numspritevalidcount = numsectors;
+    }
 }
 
 // killough 1/18/98 -- This function is used to fix the automap bug which
@@ -126,11 +144,12 @@ void R_ClearClipSegs(void)
 //
 // cph - converted to R_RecalcLineFlags. This recalculates all the flags for
 // a line, including closure and texture tiling.
+//
+// Strips rendered in parallel can reach the same line at the same time,
+// so the flags are built up locally and only stored once they are final.
 static void R_RecalcLineFlags(line_t *line)
 {
-    int c;
-
-    line->r_validcount = gametime;
+    int r_flags;
 
     if (!(line->flags & ML_TWOSIDED)
         || backsector->interpceilingheight <= frontsector->interpfloorheight
@@ -142,43 +161,42 @@ static void R_RecalcLineFlags(line_t *line)
                 || curline->sidedef->bottomtexture)
             && (backsector->ceilingpic != skyflatnum
                 || frontsector->ceilingpic != skyflatnum)))
-        line->r_flags = RF_CLOSED;
+        r_flags = RF_CLOSED;
+    else if (backsector->interpceilingheight != frontsector->interpceilingheight
+        || backsector->interpfloorheight != frontsector->interpfloorheight
+        || curline->sidedef->midtexture
+        || memcmp(&backsector->floor_xoffs, &frontsector->floor_xoffs, memcmpsize))
+        r_flags = RF_NONE;
     else
+        r_flags = RF_IGNORE;
+
+    if (r_flags != RF_NONE && !curline->sidedef->rowoffset)
     {
-        if (backsector->interpceilingheight != frontsector->interpceilingheight
-            || backsector->interpfloorheight != frontsector->interpfloorheight
-            || curline->sidedef->midtexture
-            || memcmp(&backsector->floor_xoffs, &frontsector->floor_xoffs, memcmpsize))
+        int c;
+
+        if (line->flags & ML_TWOSIDED)
         {
-            line->r_flags = RF_NONE;
-            return;
+            // Does top texture need tiling
+            if ((c = frontsector->interpceilingheight - backsector->interpceilingheight) > 0
+                && textureheight[texturetranslation[curline->sidedef->toptexture]] > c)
+                r_flags |= RF_TOP_TILE;
+
+            // Does bottom texture need tiling
+            if ((c = frontsector->interpfloorheight - backsector->interpfloorheight) > 0
+                && textureheight[texturetranslation[curline->sidedef->bottomtexture]] > c)
+                r_flags |= RF_BOT_TILE;
         }
         else
-            line->r_flags = RF_IGNORE;
+        {
+            // Does middle texture need tiling
+            if ((c = frontsector->interpceilingheight - frontsector->interpfloorheight) > 0
+                && textureheight[texturetranslation[curline->sidedef->midtexture]] > c)
+                r_flags |= RF_MID_TILE;
+        }
     }
 
-    if (curline->sidedef->rowoffset)
-        return;
-
-    if (line->flags & ML_TWOSIDED)
-    {
-        // Does top texture need tiling
-        if ((c = frontsector->interpceilingheight - backsector->interpceilingheight) > 0
-            && textureheight[texturetranslation[curline->sidedef->toptexture]] > c)
-            line->r_flags |= RF_TOP_TILE;
-
-        // Does bottom texture need tiling
-        if ((c = frontsector->interpfloorheight - backsector->interpfloorheight) > 0
-            && textureheight[texturetranslation[curline->sidedef->bottomtexture]] > c)
-            line->r_flags |= RF_BOT_TILE;
-    }
-    else
-    {
-        // Does middle texture need tiling
-        if ((c = frontsector->interpceilingheight - frontsector->interpfloorheight) > 0
-            && textureheight[texturetranslation[curline->sidedef->midtexture]] > c)
-            line->r_flags |= RF_MID_TILE;
-    }
+    line->r_flags = r_flags;
+    line->r_validcount = gametime;
 }
 
 // [AM] Interpolate the passed sector, if prudent.
@@ -231,6 +249,19 @@ static void R_MaybeInterpolateSector(sector_t *sector)
     }
 }
 
+//
+// R_InterpolateSectors
+// Interpolates every sector up front, before the view is split into strips,
+// so no thread reads a sector while another is still interpolating it.
+//
+void R_InterpolateSectors(void)
+{
+    for (int i = 0; i < numsectors; i++)
+        R_MaybeInterpolateSector(sectors + i);
+
+    sectorsinterpolated = true;
+}
+
 //
 // killough 3/7/98: Hack floor/ceiling heights for deep water etc.
 //
@@ -402,7 +433,8 @@ static void R_AddLine(seg_t *line)
         // [AM] Interpolate sector movement before
         //      running clipping tests. Frontsector
         //      should already be interpolated.
-        R_MaybeInterpolateSector(backsector);
+        if (!sectorsinterpolated)
+            R_MaybeInterpolateSector(backsector);
 
         // killough 3/8/98, 4/4/98: hack for invisible ceilings/deep water
         backsector = R_FakeFlat(backsector, &tempsec, NULL, NULL, true);
@@ -523,7 +555,8 @@ static void R_Subsector(int num)
 
     // [AM] Interpolate sector movement. Usually only needed
     //      when you're standing inside the sector.
-    R_MaybeInterpolateSector(frontsector);
+    if (!sectorsinterpolated)
+        R_MaybeInterpolateSector(frontsector);
 
     // killough 3/8/98, 4/4/98: Deep water/fake ceiling effect
     frontsector = R_FakeFlat(frontsector, &tempsec, &floorlightlevel, &ceilinglightlevel, false);
@@ -559,9 +592,9 @@ static void R_Subsector(int num)
     // Either you must pass the fake sector and handle validcount here, on the
     // real sector, or you must account for the lighting in some other way,
     // like passing it as an argument.
-    if (sector->validcount != validcount && !menuactive)
+    if (spritevalidcount[sector->id] != validcount && !menuactive)
     {
-        sector->validcount = validcount;
+        spritevalidcount[sector->id] = validcount;
         R_AddSprites(sector, (sector->heightsec ? (ceilinglightlevel + floorlightlevel) / 2 : floorlightlevel));
     }
 
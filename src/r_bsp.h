@@ -39,21 +39,24 @@
 #if !defined(__R_BSP_H__)
 #define __R_BSP_H__
 
-extern seg_t        *curline;
-extern line_t       *linedef;
-extern sector_t     *frontsector;
-extern sector_t     *backsector;
+extern THREADLOCAL seg_t      *curline;
+extern THREADLOCAL line_t     *linedef;
+extern THREADLOCAL sector_t   *frontsector;
+extern THREADLOCAL sector_t   *backsector;
 
-extern drawseg_t    *drawsegs;
+extern THREADLOCAL drawseg_t  *drawsegs;
 
-extern byte         *solidcol;
+extern THREADLOCAL byte       solidcol[SCREENWIDTH];
 
-extern drawseg_t    *ds_p;
+extern THREADLOCAL drawseg_t  *ds_p;
+
+extern dboolean               sectorsinterpolated;
 
 // BSP?
 void R_InitClipSegs(void);
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
+void R_InterpolateSectors(void);
 
 void R_RenderBSPNode(int bspnum);
 
@@ -44,6 +44,7 @@
 #include "m_config.h"
 #include "m_misc.h"
 #include "p_local.h"
+#include "p_tick.h"
 #include "r_sky.h"
 #include "sc_man.h"
 #include "w_wad.h"
@@ -827,9 +828,17 @@ int R_TextureNumForName(char *name)
 //
 // Totally rewritten by Lee Killough to use less memory,
 // to avoid using alloca(), and to improve performance.
+//
+// The flats, textures and sprites the level uses are now
+// listed here, then prepared by threads in R_PrecachePatches().
+// Flats are still cached here, and the threads only page them in.
 void R_PrecacheLevel(void)
 {
-    dboolean    *hitlist = calloc(1, sizeof(dboolean) * MAX(numtextures, numflats));
+    const int   size = MAX(MAX(numtextures, numflats), MAX(numspritelumps, NUMMOBJTYPES));
+    dboolean    *hitlist = calloc(1, sizeof(dboolean) * size);
+    dboolean    *spritehitlist = calloc(1, sizeof(dboolean) * NUMSPRITES);
+    precache_t  *list = malloc((numflats + numtextures + numspritelumps) * sizeof(*list));
+    int         count = 0;
 
     // Precache flats.
     for (int i = 0; i < numsectors; i++)
@@ -838,12 +847,17 @@ void R_PrecacheLevel(void)
         hitlist[sectors[i].ceilingpic] = true;
     }
 
+    // the renderer reads flats straight from their lump's cache, so they must be cached now
     for (int i = 0; i < numflats; i++)
         if (hitlist[i])
+        {
             W_CacheLumpNum(firstflat + i);
+            list[count].type = PRECACHE_FLAT;
+            list[count++].id = firstflat + i;
+        }
 
     // Precache textures.
-    memset(hitlist, false, sizeof(*hitlist));
+    memset(hitlist, false, sizeof(*hitlist) * size);
 
     for (int i = 0; i < numsides; i++)
     {
@@ -863,11 +877,50 @@ void R_PrecacheLevel(void)
     for (int i = 0; i < numtextures; i++)
         if (hitlist[i])
         {
-            texture_t   *texture = textures[i];
+            list[count].type = PRECACHE_TEXTURE;
+            list[count++].id = i;
+        }
+
+    // Precache sprites of every state a thing in the level may start to be in.
+    memset(hitlist, false, sizeof(*hitlist) * size);
+
+    for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
+        hitlist[((mobj_t *)th)->type] = true;
+
+    for (int i = 0; i < NUMMOBJTYPES; i++)
+        if (hitlist[i])
+        {
+            const mobjinfo_t    *info = &mobjinfo[i];
+            const int           statenums[] =
+            {
+                info->spawnstate, info->seestate, info->painstate, info->meleestate,
+                info->missilestate, info->deathstate, info->xdeathstate, info->raisestate
+            };
 
-            for (int j = 0; j < texture->patchcount; j++)
-                W_CacheLumpNum(texture->patches[j].patch);
+            for (int j = 0; j < arrlen(statenums); j++)
+                if (statenums[j] != S_NULL)
+                    spritehitlist[states[statenums[j]].sprite] = true;
         }
 
+    memset(hitlist, false, sizeof(*hitlist) * size);
+
+    for (int i = 0; i < NUMSPRITES; i++)
+        if (spritehitlist[i])
+            for (int j = 0; j < sprites[i].numframes; j++)
+                for (int k = 0; k < 16; k++)
+                {
+                    const int   lump = sprites[i].spriteframes[j].lump[k];
+
+                    if (lump >= 0 && lump < numspritelumps && !hitlist[lump])
+                    {
+                        hitlist[lump] = true;
+                        list[count].type = PRECACHE_SPRITE;
+                        list[count++].id = firstspritelump + lump;
+                    }
+                }
+
+    free(spritehitlist);
     free(hitlist);
+
+    R_PrecachePatches(list, count);
 }
@@ -141,8 +141,6 @@ typedef struct sector_s
     int                 linecount;
     struct line_s       **lines;                // [linecount] size
 
-    int                 cachedheight;
-
     // [AM] Previous position of floor and ceiling before
     //      think. Used to interpolate between positions.
     fixed_t             oldfloorheight;
@@ -129,28 +129,28 @@ static const byte megasphere[] =
 // R_DrawColumn
 // Source is the top of the column to scale.
 //
-lighttable_t    *dc_colormap[2];
-int             dc_x;
-int             dc_yl;
-int             dc_yh;
-fixed_t         dc_iscale;
-fixed_t         dc_texturemid;
-fixed_t         dc_texheight;
-fixed_t         dc_texturefrac;
-byte            dc_solidblood;
-byte            *dc_blood;
-byte            *dc_brightmap;
-int             dc_floorclip;
-int             dc_ceilingclip;
-int             dc_numposts;
-byte            dc_black;
-byte            *dc_black25;
-byte            *dc_black40;
+THREADLOCAL lighttable_t     *dc_colormap[2];
+THREADLOCAL int              dc_x;
+THREADLOCAL int              dc_yl;
+THREADLOCAL int              dc_yh;
+THREADLOCAL fixed_t          dc_iscale;
+THREADLOCAL fixed_t          dc_texturemid;
+THREADLOCAL fixed_t          dc_texheight;
+THREADLOCAL fixed_t          dc_texturefrac;
+THREADLOCAL byte             dc_solidblood;
+THREADLOCAL byte             *dc_blood;
+THREADLOCAL byte             *dc_brightmap;
+THREADLOCAL int              dc_floorclip;
+THREADLOCAL int              dc_ceilingclip;
+THREADLOCAL int              dc_numposts;
+THREADLOCAL byte             dc_black;
+THREADLOCAL byte             *dc_black25;
+THREADLOCAL byte             *dc_black40;
 
 // first pixel in a column (possibly virtual)
-byte            *dc_source;
+THREADLOCAL byte             *dc_source;
 
-extern int      fuzzpos;
+extern THREADLOCAL int       fuzzpos;
 
 //
 // A column is a vertical slice/span from a wall texture that,
@@ -227,7 +227,7 @@ void R_DrawFuzzyShadowColumn(void)
     byte    *dest = ylookup0[dc_yl] + dc_x;
 
     if (((consoleactive || freeze) && !fuzztable[fuzzpos++])
-        || (!consoleactive && !freeze && !(M_Random() & 3)))
+        || (!consoleactive && !freeze && !(M_CosmeticRandom() & 3)))
         *dest = *(*dest + dc_black25);
 
     dest += SCREENWIDTH;
@@ -240,7 +240,7 @@ void R_DrawFuzzyShadowColumn(void)
 
     if (dc_yh < dc_floorclip
         && (((consoleactive || freeze) && !fuzztable[fuzzpos++])
-            || (!consoleactive && !freeze && !(M_Random() & 3))))
+            || (!consoleactive && !freeze && !(M_CosmeticRandom() & 3))))
         *dest = *(*dest + dc_black25);
 }
 
@@ -264,7 +264,7 @@ void R_DrawSolidFuzzyShadowColumn(void)
     byte    *dest = ylookup0[dc_yl] + dc_x;
 
     if (((consoleactive || freeze) && !fuzztable[fuzzpos++])
-        || (!consoleactive && !freeze && !(M_Random() & 3)))
+        || (!consoleactive && !freeze && !(M_CosmeticRandom() & 3)))
         *dest = dc_black;
 
     dest += SCREENWIDTH;
@@ -277,7 +277,7 @@ void R_DrawSolidFuzzyShadowColumn(void)
 
     if (dc_yh < dc_floorclip
         && (((consoleactive || freeze) && !fuzztable[fuzzpos++])
-            || (!consoleactive && !freeze && !(M_Random() & 3))))
+            || (!consoleactive && !freeze && !(M_CosmeticRandom() & 3))))
         *dest = dc_black;
 }
 
@@ -309,14 +309,98 @@ void R_DrawSolidBloodSplatColumn(void)
     *dest = dc_solidblood;
 }
 
+//
+// Wall column batching
+// Wall columns are drawn into a buffer that holds BATCHWIDTH adjacent columns with
+// each of their rows next to each other, rather than straight to the screen where each
+// row of a column is SCREENWIDTH bytes from the next. The buffer is then copied to the
+// screen a row at a time, as soon as a column outside of it is drawn, or once the wall
+// is done. Each tier of a wall is batched separately since they can share columns.
+//
+#define BATCHWIDTH  4
+
+typedef struct
+{
+    byte    buffer[SCREENHEIGHT * BATCHWIDTH];
+    int     x;
+    int     columns;
+    int     yl[BATCHWIDTH];
+    int     yh[BATCHWIDTH];
+} wallbatch_t;
+
+static THREADLOCAL wallbatch_t  wallbatches[NUMWALLBATCHES];
+THREADLOCAL int                 dc_batch;
+
+static void R_FlushWallBatchColumn(const wallbatch_t *batch, const int column, int yl, const int yh)
+{
+    const byte  *source = batch->buffer + yl * BATCHWIDTH + column;
+    byte        *dest = ylookup0[yl] + batch->x + column;
+
+    for (; yl <= yh; yl++)
+    {
+        *dest = *source;
+        dest += SCREENWIDTH;
+        source += BATCHWIDTH;
+    }
+}
+
+static void R_FlushWallBatch(wallbatch_t *batch)
+{
+    const int   *yl = batch->yl;
+    const int   *yh = batch->yh;
+    int         top;
+    int         bottom;
+
+    if (batch->columns == (1 << BATCHWIDTH) - 1
+        && (top = MAX(MAX(yl[0], yl[1]), MAX(yl[2], yl[3]))) <= (bottom = MIN(MIN(yh[0], yh[1]), MIN(yh[2], yh[3]))))
+    {
+        // copy the rows all of the columns share a whole row at a time
+        const byte  *source = batch->buffer + top * BATCHWIDTH;
+
+        for (int y = top; y <= bottom; y++, source += BATCHWIDTH)
+            memcpy(ylookup0[y] + batch->x, source, BATCHWIDTH);
+
+        // then the rest of each column above and below them
+        for (int i = 0; i < BATCHWIDTH; i++)
+        {
+            R_FlushWallBatchColumn(batch, i, yl[i], top - 1);
+            R_FlushWallBatchColumn(batch, i, bottom + 1, yh[i]);
+        }
+    }
+    else
+        for (int i = 0; i < BATCHWIDTH; i++)
+            if (batch->columns & (1 << i))
+                R_FlushWallBatchColumn(batch, i, yl[i], yh[i]);
+
+    batch->columns = 0;
+}
+
+void R_FlushWallColumns(void)
+{
+    for (int i = 0; i < NUMWALLBATCHES; i++)
+        if (wallbatches[i].columns)
+            R_FlushWallBatch(&wallbatches[i]);
+}
+
 void R_DrawWallColumn(void)
 {
+    wallbatch_t         *batch = &wallbatches[dc_batch];
+    const int           column = (dc_x & (BATCHWIDTH - 1));
     int                 y = dc_yh - dc_yl + 1;
-    byte                *dest = ylookup0[dc_yl] + dc_x;
+    byte                *dest;
     fixed_t             frac = dc_texturemid + (dc_yl - centery) * dc_iscale;
     const lighttable_t  *colormap = dc_colormap[0];
     fixed_t             heightmask = dc_texheight - 1;
 
+    if (batch->columns && (batch->x != dc_x - column || (batch->columns & (1 << column))))
+        R_FlushWallBatch(batch);
+
+    batch->x = dc_x - column;
+    batch->columns |= (1 << column);
+    batch->yl[column] = dc_yl;
+    batch->yh[column] = dc_yh;
+    dest = batch->buffer + dc_yl * BATCHWIDTH + column;
+
     if (dc_texheight & heightmask)
     {
         heightmask = (heightmask + 1) << FRACBITS;
@@ -330,7 +414,7 @@ void R_DrawWallColumn(void)
         while (--y)
         {
             *dest = colormap[dc_source[frac >> FRACBITS]];
-            dest += SCREENWIDTH;
+            dest += BATCHWIDTH;
 
             if ((frac += dc_iscale) >= heightmask)
                 frac -= heightmask;
@@ -343,7 +427,7 @@ void R_DrawWallColumn(void)
         while (--y)
         {
             *dest = colormap[dc_source[(frac >> FRACBITS) & heightmask]];
-            dest += SCREENWIDTH;
+            dest += BATCHWIDTH;
             frac += dc_iscale;
         }
 
@@ -933,7 +1017,7 @@ void R_DrawFuzzColumn(void)
     // top
     if (!dc_yl)
         *dest = fullcolormap[6 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(0, 1))]];
-    else if (!(M_Random() & 3))
+    else if (!(M_CosmeticRandom() & 3))
         *dest = fullcolormap[12 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(-1, 1))]];
 
     dest += SCREENWIDTH;
@@ -948,7 +1032,7 @@ void R_DrawFuzzColumn(void)
     // bottom
     *dest = fullcolormap[5 * 256 + dest[(fuzztable[fuzzpos++] = FUZZ(-1, 0))]];
 
-    if (dc_yh < dc_floorclip && !(M_Random() & 3))
+    if (dc_yh < dc_floorclip && !(M_CosmeticRandom() & 3))
     {
         dest += SCREENWIDTH;
         *dest = fullcolormap[14 * 256 + dest[(fuzztable[fuzzpos] = FUZZ(-1, 0))]];
@@ -1014,7 +1098,7 @@ void R_DrawFuzzColumns(void)
                 if (!y || *(src - SCREENWIDTH) == NOFUZZ)
                 {
                     // top
-                    if (!(M_Random() & 3))
+                    if (!(M_CosmeticRandom() & 3))
                         *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(-1, 1))]];
                 }
                 else if (y == h - SCREENWIDTH)
@@ -1025,7 +1109,7 @@ void R_DrawFuzzColumns(void)
                 else if (*(src + SCREENWIDTH) == NOFUZZ)
                 {
                     // bottom of post
-                    if (!(M_Random() & 3))
+                    if (!(M_CosmeticRandom() & 3))
                         *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(-1, 1))]];
                 }
                 else
@@ -1033,7 +1117,7 @@ void R_DrawFuzzColumns(void)
                     // middle
                     if (*(src - 1) == NOFUZZ || *(src + 1) == NOFUZZ)
                     {
-                        if (!(M_Random() & 3))
+                        if (!(M_CosmeticRandom() & 3))
                             *dest = fullcolormap[12 * 256 + dest[(fuzztable[i] = FUZZ(-1, 1))]];
                     }
                     else
@@ -1099,8 +1183,8 @@ void R_DrawPausedFuzzColumns(void)
 //  of the BaronOfHell, the HellKnight, uses
 //  identical sprites, kinda brightened up.
 //
-byte    *dc_translation;
-byte    translationtables[256 * 3];
+THREADLOCAL byte    *dc_translation;
+byte                translationtables[256 * 3];
 
 void R_DrawTranslatedColumn(void)
 {
@@ -1158,19 +1242,19 @@ void R_InitTranslationTables(void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int             ds_y;
-int             ds_x1;
-int             ds_x2;
+THREADLOCAL int              ds_y;
+THREADLOCAL int              ds_x1;
+THREADLOCAL int              ds_x2;
 
-lighttable_t    *ds_colormap;
+THREADLOCAL lighttable_t     *ds_colormap;
 
-fixed_t         ds_xfrac;
-fixed_t         ds_yfrac;
-fixed_t         ds_xstep;
-fixed_t         ds_ystep;
+THREADLOCAL fixed_t          ds_xfrac;
+THREADLOCAL fixed_t          ds_yfrac;
+THREADLOCAL fixed_t          ds_xstep;
+THREADLOCAL fixed_t          ds_ystep;
 
 // start of a 64x64 tile image
-byte            *ds_source;
+THREADLOCAL byte             *ds_source;
 
 //
 // Draws the actual span.
@@ -48,29 +48,40 @@
 
 #define NOTEXTURECOLOR  80
 
-extern lighttable_t     *dc_colormap[2];
-extern int              dc_x;
-extern int              dc_yl;
-extern int              dc_yh;
-extern fixed_t          dc_iscale;
-extern fixed_t          dc_texturemid;
-extern fixed_t          dc_texheight;
-extern fixed_t          dc_texturefrac;
-extern byte             dc_solidblood;
-extern byte             *dc_blood;
-extern byte             *dc_brightmap;
-extern int              dc_floorclip;
-extern int              dc_ceilingclip;
-extern int              dc_numposts;
-extern byte             dc_black;
-extern byte             *dc_black25;
-extern byte             *dc_black40;
+extern THREADLOCAL lighttable_t     *dc_colormap[2];
+extern THREADLOCAL int              dc_x;
+extern THREADLOCAL int              dc_yl;
+extern THREADLOCAL int              dc_yh;
+extern THREADLOCAL fixed_t          dc_iscale;
+extern THREADLOCAL fixed_t          dc_texturemid;
+extern THREADLOCAL fixed_t          dc_texheight;
+extern THREADLOCAL fixed_t          dc_texturefrac;
+extern THREADLOCAL byte             dc_solidblood;
+extern THREADLOCAL byte             *dc_blood;
+extern THREADLOCAL byte             *dc_brightmap;
+extern THREADLOCAL int              dc_floorclip;
+extern THREADLOCAL int              dc_ceilingclip;
+extern THREADLOCAL int              dc_numposts;
+extern THREADLOCAL byte             dc_black;
+extern THREADLOCAL byte             *dc_black25;
+extern THREADLOCAL byte             *dc_black40;
 
 // first pixel in a column
-extern byte             *dc_source;
+extern THREADLOCAL byte             *dc_source;
 
-extern const int        fuzzrange[3];
-extern int              fuzztable[SCREENWIDTH * SCREENHEIGHT];
+// wall columns are batched separately for each tier of a wall
+enum
+{
+    TOPWALLBATCH,
+    MIDWALLBATCH,
+    BOTTOMWALLBATCH,
+    NUMWALLBATCHES
+};
+
+extern THREADLOCAL int              dc_batch;
+
+extern const int                    fuzzrange[3];
+extern int                          fuzztable[SCREENWIDTH * SCREENHEIGHT];
 
 // The span blitting interface.
 // Hook in assembler or system specific BLT here.
@@ -78,6 +89,7 @@ void R_DrawColumn(void);
 void R_DrawColorColumn(void);
 void R_DrawWallColumn(void);
 void R_DrawBrightMapWallColumn(void);
+void R_FlushWallColumns(void);
 void R_DrawSkyColumn(void);
 void R_DrawFlippedSkyColumn(void);
 void R_DrawSkyColorColumn(void);
@@ -125,22 +137,22 @@ void R_DrawTranslatedColumn(void);
 
 void R_VideoErase(unsigned int ofs, int count);
 
-extern int          ds_y;
-extern int          ds_x1;
-extern int          ds_x2;
+extern THREADLOCAL int              ds_y;
+extern THREADLOCAL int              ds_x1;
+extern THREADLOCAL int              ds_x2;
 
-extern lighttable_t *ds_colormap;
+extern THREADLOCAL lighttable_t     *ds_colormap;
 
-extern fixed_t      ds_xfrac;
-extern fixed_t      ds_yfrac;
-extern fixed_t      ds_xstep;
-extern fixed_t      ds_ystep;
+extern THREADLOCAL fixed_t          ds_xfrac;
+extern THREADLOCAL fixed_t          ds_yfrac;
+extern THREADLOCAL fixed_t          ds_xstep;
+extern THREADLOCAL fixed_t          ds_ystep;
 
 // start of a 64*64 tile image
-extern byte         *ds_source;
+extern THREADLOCAL byte             *ds_source;
 
-extern byte         translationtables[256 * 3];
-extern byte         *dc_translation;
+extern byte                         translationtables[256 * 3];
+extern THREADLOCAL byte             *dc_translation;
 
 // Span blitting for rows, floor/ceiling.
 // No Spectre effect needed.
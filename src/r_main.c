@@ -36,11 +36,14 @@
 ========================================================================
 */
 
+#include "SDL.h"
+
 #include "c_console.h"
 #include "doomstat.h"
 #include "i_colors.h"
 #include "i_timer.h"
 #include "m_config.h"
+#include "m_menu.h"
 #include "m_random.h"
 #include "p_local.h"
 #include "p_setup.h"
@@ -51,6 +54,9 @@
 // increment every time a check is made
 int                 validcount = 1;
 
+THREADLOCAL int     stripx1;
+THREADLOCAL int     stripx2;
+
 lighttable_t        *fixedcolormap;
 
 dboolean            usebrightmaps;
@@ -123,13 +129,14 @@ dboolean            r_shadows_translucency = r_shadows_translucency_default;
 dboolean            r_shake_barrels = r_shake_barrels_default;
 int                 r_skycolor = r_skycolor_default;
 dboolean            r_textures = r_textures_default;
+int                 r_threads = r_threads_default;
 dboolean            r_translucency = r_translucency_default;
 
 extern dboolean     canmouselook;
 extern int          barrelms;
 extern dboolean     transferredsky;
 extern dboolean     vanilla;
-extern lighttable_t **walllights;
+extern THREADLOCAL lighttable_t **walllights;
 
 //
 // R_PointOnSide
@@ -483,7 +490,7 @@ void R_ExecuteSetViewSize(void)
     }
 }
 
-void (*colfunc)(void);
+THREADLOCAL void (*colfunc)(void);
 void (*wallcolfunc)(void);
 void (*bmapwallcolfunc)(void);
 void (*segcolfunc)(void);
@@ -805,9 +812,9 @@ static void R_SetupFrame(void)
 
         if (barrelms > time && !consoleactive && !menuactive && !paused)
         {
-            viewx += M_RandomInt(-3, 3) * FRACUNIT * (barrelms - time) / BARRELMS;
-            viewy += M_RandomInt(-3, 3) * FRACUNIT * (barrelms - time) / BARRELMS;
-            viewz += M_RandomInt(-2, 2) * FRACUNIT * (barrelms - time) / BARRELMS;
+            viewx += M_CosmeticRandomInt(-3, 3) * FRACUNIT * (barrelms - time) / BARRELMS;
+            viewy += M_CosmeticRandomInt(-3, 3) * FRACUNIT * (barrelms - time) / BARRELMS;
+            viewz += M_CosmeticRandomInt(-2, 2) * FRACUNIT * (barrelms - time) / BARRELMS;
         }
     }
 
@@ -863,11 +870,19 @@ static void R_SetupFrame(void)
 }
 
 //
-// R_RenderPlayerView
+// R_RenderView
+// Renders the columns of the player's view from x1 to x2.
 //
-void R_RenderPlayerView(void)
+static void R_RenderView(const int x1, const int x2)
 {
-    R_SetupFrame();
+    // only the main thread's strip is profiled
+    const dboolean  profile = (profiling && !x1);
+
+    stripx1 = x1;
+    stripx2 = x2;
+
+    // brightmaps are always drawn using the first colormap
+    dc_colormap[1] = colormaps[0];
 
     // Clear buffers.
     R_ClearClipSegs();
@@ -875,8 +890,129 @@ void R_RenderPlayerView(void)
     R_ClearPlanes();
     R_ClearSprites();
 
+    if (profile)
+        I_StartProfile(PROFILE_BSP);
+
+    R_RenderBSPNode(numnodes - 1);  // head node is the last node output
+
+    if (profile)
+    {
+        I_EndProfile(PROFILE_BSP);
+        I_StartProfile(PROFILE_PLANES);
+    }
+
+    R_DrawPlanes();
+
+    if (profile)
+    {
+        I_EndProfile(PROFILE_PLANES);
+        I_StartProfile(PROFILE_MASKED);
+    }
+
+    R_DrawMasked();
+
+    if (profile)
+        I_EndProfile(PROFILE_MASKED);
+}
+
+//
+// Render threads
+// If r_threads is greater than 1, the player's view is split into that many
+// vertical strips which are rendered at the same time. The main thread renders
+// the first strip, and each of the others is rendered by a thread of its own.
+//
+typedef struct
+{
+    SDL_Thread  *thread;
+    SDL_sem     *start;
+    SDL_sem     *done;
+    int         x1;
+    int         x2;
+} renderthread_t;
+
+static renderthread_t   renderthreads[r_threads_max - 1];
+static int              numrenderthreads;
+
+static int SDLCALL R_RenderThread(void *data)
+{
+    renderthread_t  *renderthread = data;
+
+    M_SeedCosmetic((unsigned int)(renderthread - renderthreads) + 2);
+
+    while (true)
+    {
+        SDL_SemWait(renderthread->start);
+        R_RenderView(renderthread->x1, renderthread->x2);
+        SDL_SemPost(renderthread->done);
+    }
+
+    return 0;
+}
+
+static dboolean R_CreateRenderThreads(const int count)
+{
+    while (numrenderthreads < count)
+    {
+        renderthread_t  *renderthread = &renderthreads[numrenderthreads];
+
+        if (!renderthread->start && !(renderthread->start = SDL_CreateSemaphore(0)))
+            return false;
+
+        if (!renderthread->done && !(renderthread->done = SDL_CreateSemaphore(0)))
+            return false;
+
+        if (!(renderthread->thread = SDL_CreateThread(&R_RenderThread, "R_RenderThread", renderthread)))
+            return false;
+
+        numrenderthreads++;
+    }
+
+    return true;
+}
+
+static void R_RenderViewInStrips(const int strips)
+{
+    const int   width = viewwidth / strips;
+
+    // interpolate every sector before any thread needs one
+    R_InterpolateSectors();
+
+    for (int i = 0, x = width; i < strips - 1; i++, x += width)
+    {
+        renderthread_t  *renderthread = &renderthreads[i];
+
+        renderthread->x1 = x;
+        renderthread->x2 = (i == strips - 2 ? viewwidth - 1 : x + width - 1);
+        SDL_SemPost(renderthread->start);
+    }
+
+    R_RenderView(0, width - 1);
+
+    for (int i = 0; i < strips - 1; i++)
+        SDL_SemWait(renderthreads[i].done);
+
+    sectorsinterpolated = false;
+}
+
+//
+// R_RenderPlayerView
+//
+void R_RenderPlayerView(void)
+{
+    R_FreeTextureComposites();
+    R_SetupFrame();
+
     if (automapactive)
     {
+        stripx1 = 0;
+        stripx2 = viewwidth - 1;
+
+        // Clear buffers.
+        R_ClearClipSegs();
+        R_ClearDrawSegs();
+        R_ClearPlanes();
+        R_ClearSprites();
+
         R_RenderBSPNode(numnodes - 1);
         return;
     }
@@ -888,9 +1024,23 @@ void R_RenderPlayerView(void)
         V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight,
             (viewplayer->fixedcolormap == INVERSECOLORMAP ? nearestwhite : nearestblack), false);
 
-    R_RenderBSPNode(numnodes - 1);  // head node is the last node output
-    R_DrawPlanes();
-    R_DrawMasked();
+    if (r_threads > 1)
+    {
+        if (R_CreateRenderThreads(r_threads - 1))
+            R_RenderViewInStrips(r_threads);
+        else
+        {
+            C_Warning(1, "The player's view can't be rendered using %i threads.", r_threads);
+            r_threads = 1;
+            R_RenderView(0, viewwidth - 1);
+        }
+    }
+    else
+        R_RenderView(0, viewwidth - 1);
+
+    // draw the psprites on top of everything
+    if (r_playersprites && !inhelpscreens && (!menuactive || consoleactive))
+        R_DrawPlayerSprites();
 
     if (!r_textures && viewplayer->fixedcolormap == INVERSECOLORMAP)
         V_InvertScreen();
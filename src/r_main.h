@@ -59,6 +59,10 @@ extern fixed_t  projection;
 
 extern int      validcount;
 
+// the columns of the view rendered by the current thread
+extern THREADLOCAL int  stripx1;
+extern THREADLOCAL int  stripx2;
+
 //
 // Lighting LUT.
 // Used for z-depth cuing per column/row,
@@ -100,7 +104,7 @@ extern fixed_t      fractionaltic;
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
 //
-void (*colfunc)(void);
+extern THREADLOCAL void (*colfunc)(void);
 void (*wallcolfunc)(void);
 void (*bmapwallcolfunc)(void);
 void (*segcolfunc)(void);
@@ -66,8 +66,12 @@
 **---------------------------------------------------------------------------
 */
 
+#include "SDL.h"
+
 #include "c_console.h"
 #include "i_swap.h"
+#include "i_system.h"
+#include "m_config.h"
 #include "m_misc.h"
 #include "r_main.h"
 #include "w_wad.h"
@@ -85,6 +89,34 @@
 static rpatch_t     *patches;
 static rpatch_t     *texture_composites;
 
+//
+// Patches and texture composites are only created the first time they are needed, which may
+// be by any of the render threads or by R_PrecachePatches(). The first thread to need one
+// claims it and creates it, and any other thread that needs it at the same time waits until
+// it is complete. Composites not used recently are freed between frames, when no thread is
+// rendering, if they take up more than r_texturecache MB. Lumps in WAD files that couldn't be
+// memory-mapped are read into the zone, which isn't thread-safe, so creating anything from them,
+// and warning about patches in an unknown format, is only done by one thread at a time.
+//
+enum
+{
+    PATCH_NONE,
+    PATCH_CREATING,
+    PATCH_CREATED,
+    PATCH_INVALID
+};
+
+static SDL_atomic_t     *patchstate;
+static SDL_atomic_t     *compositestate;
+static int              *compositesize;
+static int              *compositelastused;
+static size_t           compositebytes;
+static SDL_SpinLock     compositelock;
+static int              compositeframe;
+static SDL_mutex        *patchmutex;
+
+int                     r_texturecache = r_texturecache_default;
+
 static short        BIGDOOR7;
 static short        FIREBLU1;
 static short        SKY1;
@@ -171,7 +203,11 @@ static void createPatch(int id)
     if (!CheckIfPatch(patchNum) && patchNum < numlumps)
     {
         if (lumpinfo[patchNum]->size > 0)
+        {
+            SDL_LockMutex(patchmutex);
             C_Warning(1, "The <b>%s</b> patch is in an unknown format.", lumpinfo[patchNum]->name);
+            SDL_UnlockMutex(patchmutex);
+        }
 
         return;
     }
@@ -210,7 +246,7 @@ static void createPatch(int id)
 
     // allocate our data chunk
     dataSize = pixelDataSize + columnsDataSize + postsDataSize;
-    patch->data = Z_Calloc(1, dataSize, PU_CACHE, (void **)&patch->data);
+    patch->data = calloc(1, dataSize);
 
     // set out pixel, column, and post pointers into our data array
     patch->pixels = patch->data;
@@ -410,7 +446,11 @@ static void createTextureCompositePatch(int id)
 
     // allocate our data chunk
     dataSize = pixelDataSize + columnsDataSize + postsDataSize;
-    composite_patch->data = Z_Calloc(1, dataSize, PU_STATIC, (void **)&composite_patch->data);
+    composite_patch->data = calloc(1, dataSize);
+    compositesize[id] = dataSize;
+    SDL_AtomicLock(&compositelock);
+    compositebytes += dataSize;
+    SDL_AtomicUnlock(&compositelock);
 
     // set out pixel, column, and post pointers into our data array
     composite_patch->pixels = composite_patch->data;
@@ -588,30 +628,268 @@ static void createTextureCompositePatch(int id)
 void R_InitPatches(void)
 {
     patches = calloc(numlumps, sizeof(rpatch_t));
+    patchstate = calloc(numlumps, sizeof(*patchstate));
 
     texture_composites = calloc(numtextures, sizeof(rpatch_t));
+    compositestate = calloc(numtextures, sizeof(*compositestate));
+    compositesize = calloc(numtextures, sizeof(*compositesize));
+    compositelastused = calloc(numtextures, sizeof(*compositelastused));
+
+    if (!(patchmutex = SDL_CreateMutex()))
+        I_Error("R_InitPatches: %s", SDL_GetError());
 
     BIGDOOR7 = R_CheckTextureNumForName("BIGDOOR7");
     FIREBLU1 = R_CheckTextureNumForName("FIREBLU1");
     SKY1 = R_CheckTextureNumForName("SKY1");
+}
+
+static dboolean R_IsLumpMapped(int lump)
+{
+    return (W_LumpMappedData(lump) != NULL);
+}
+
+static dboolean isCompositeMapped(int id)
+{
+    const texture_t *texture = textures[id];
 
-    for (int i = 0; i < numspritelumps; i++)
-        createPatch(firstspritelump + i);
+    for (int i = 0; i < texture->patchcount; i++)
+        if (!R_IsLumpMapped(texture->patches[i].patch))
+            return false;
 
-    for (int i = 0; i < numtextures; i++)
-        createTextureCompositePatch(i);
+    return true;
+}
+
+static void createPatchOnce(SDL_atomic_t *state, void (*create)(int), const rpatch_t *patch, int id,
+    dboolean (*ismapped)(int))
+{
+    while (true)
+    {
+        const int   value = state->value;
+
+        if (value == PATCH_CREATED || value == PATCH_INVALID)
+        {
+            SDL_MemoryBarrierAcquire();
+            return;
+        }
+        else if (value == PATCH_NONE && SDL_AtomicCAS(state, PATCH_NONE, PATCH_CREATING))
+        {
+            // SDL mutexes are recursive, so createPatch() can still lock it to warn
+            if (ismapped(id))
+                create(id);
+            else
+            {
+                SDL_LockMutex(patchmutex);
+                create(id);
+                SDL_UnlockMutex(patchmutex);
+            }
+
+            SDL_AtomicSet(state, (patch->data ? PATCH_CREATED : PATCH_INVALID));
+            return;
+        }
+
+        // another thread is creating it
+        SDL_Delay(0);
+    }
 }
 
 const rpatch_t *R_CachePatchNum(int id)
 {
+    if (patchstate[id].value != PATCH_CREATED)
+        createPatchOnce(&patchstate[id], &createPatch, &patches[id], id, &R_IsLumpMapped);
+    else
+        SDL_MemoryBarrierAcquire();
+
     return &patches[id];
 }
 
 const rpatch_t *R_CacheTextureCompositePatchNum(int id)
 {
+    if (compositestate[id].value != PATCH_CREATED)
+        createPatchOnce(&compositestate[id], &createTextureCompositePatch, &texture_composites[id], id,
+            &isCompositeMapped);
+    else
+        SDL_MemoryBarrierAcquire();
+
+    compositelastused[id] = compositeframe;
     return &texture_composites[id];
 }
 
+//
+// Level precaching
+// The flats, textures and sprites a level uses are loaded and prepared by a few threads while
+// the player's view starts to be rendered, rather than either all at once before it or each
+// the first time it is seen. Only lumps in memory-mapped WAD files are handled by these
+// threads, as lumps in other WADs are read into the zone, which isn't thread-safe, and are
+// left to be prepared when first needed instead.
+//
+#define MAXPRECACHETHREADS  4
+
+static precache_t       *precachelist;
+static int              precachecount;
+static SDL_atomic_t     precachenext;
+static SDL_atomic_t     precachecancel;
+static SDL_Thread       *precachethreads[MAXPRECACHETHREADS];
+static int              numprecachethreads;
+
+static void R_PrecacheFlat(int lump)
+{
+    // read a byte from each page so the flat is paged in. It was already cached by
+    // R_PrecacheLevel(), so its cache isn't written to here while it is being rendered.
+    const byte      *data = lumpinfo[lump]->cache;
+    const int       size = lumpinfo[lump]->size;
+    volatile byte   sum = 0;
+
+    if (!data)
+        return;
+
+    for (int i = 0; i < size; i += 4096)
+        sum += data[i];
+}
+
+static void R_PrecacheTexture(int id)
+{
+    if (!isCompositeMapped(id))
+        return;
+
+    createPatchOnce(&compositestate[id], &createTextureCompositePatch, &texture_composites[id], id,
+        &isCompositeMapped);
+
+    // mark it as used now, so it isn't the first to be freed before it is ever drawn
+    compositelastused[id] = compositeframe;
+}
+
+static void R_PrecacheSprite(int lump)
+{
+    // leave patches in an unknown format to be warned about when first needed
+    if (R_IsLumpMapped(lump) && CheckIfPatch(lump))
+        R_CachePatchNum(lump);
+}
+
+static int SDLCALL R_PrecacheThread(void *data)
+{
+    int i;
+
+    while (!SDL_AtomicGet(&precachecancel) && (i = SDL_AtomicAdd(&precachenext, 1)) < precachecount)
+    {
+        const precache_t    *precache = &precachelist[i];
+
+        switch (precache->type)
+        {
+            case PRECACHE_FLAT:
+                if (R_IsLumpMapped(precache->id))
+                    R_PrecacheFlat(precache->id);
+
+                break;
+
+            case PRECACHE_TEXTURE:
+                R_PrecacheTexture(precache->id);
+                break;
+
+            case PRECACHE_SPRITE:
+                R_PrecacheSprite(precache->id);
+                break;
+        }
+    }
+
+    return 0;
+}
+
+//
+// Wait for the threads started by R_PrecachePatches() to finish, or stop them early if
+// cancel is true.
+//
+void R_WaitForPrecache(dboolean cancel)
+{
+    if (cancel)
+        SDL_AtomicSet(&precachecancel, 1);
+
+    for (int i = 0; i < numprecachethreads; i++)
+        SDL_WaitThread(precachethreads[i], NULL);
+
+    numprecachethreads = 0;
+    free(precachelist);
+    precachelist = NULL;
+    precachecount = 0;
+}
+
+//
+// Start precaching the given list of flats, textures and sprites, which is then owned by
+// these threads. If no threads can be created, they are precached before returning.
+//
+void R_PrecachePatches(precache_t *list, int count)
+{
+    const int   threads = BETWEEN(1, SDL_GetCPUCount() - 1, MAXPRECACHETHREADS);
+
+    R_WaitForPrecache(true);
+
+    precachelist = list;
+    precachecount = count;
+    SDL_AtomicSet(&precachenext, 0);
+    SDL_AtomicSet(&precachecancel, 0);
+
+    while (numprecachethreads < threads)
+    {
+        if (!(precachethreads[numprecachethreads] = SDL_CreateThread(&R_PrecacheThread, "R_PrecacheThread", NULL)))
+            break;
+
+        numprecachethreads++;
+    }
+
+    if (!numprecachethreads)
+    {
+        R_PrecacheThread(NULL);
+        R_WaitForPrecache(false);
+    }
+}
+
+static int compareLastUsed(const void *a, const void *b)
+{
+    return (compositelastused[*(const int *)a] - compositelastused[*(const int *)b]);
+}
+
+//
+// Free the least recently used texture composites, other than those used in the last frame,
+// until they take up less than r_texturecache MB. This must only be called when no render
+// threads are running.
+//
+void R_FreeTextureComposites(void)
+{
+    const size_t    budget = (size_t)r_texturecache << 20;
+
+    compositeframe++;
+
+    if (compositebytes > budget)
+    {
+        int *ids = malloc(numtextures * sizeof(*ids));
+        int count = 0;
+
+        for (int i = 0; i < numtextures; i++)
+            if (compositestate[i].value == PATCH_CREATED && compositelastused[i] < compositeframe - 1)
+                ids[count++] = i;
+
+        qsort(ids, count, sizeof(*ids), &compareLastUsed);
+
+        for (int i = 0; i < count && compositebytes > budget; i++)
+        {
+            const int   id = ids[i];
+
+            // claim it so it isn't created again while it is being freed
+            if (!SDL_AtomicCAS(&compositestate[id], PATCH_CREATED, PATCH_CREATING))
+                continue;
+
+            free(texture_composites[id].data);
+            memset(&texture_composites[id], 0, sizeof(rpatch_t));
+            SDL_AtomicLock(&compositelock);
+            compositebytes -= compositesize[id];
+            SDL_AtomicUnlock(&compositelock);
+            compositesize[id] = 0;
+            SDL_AtomicSet(&compositestate[id], PATCH_NONE);
+        }
+
+        free(ids);
+    }
+}
+
 const rcolumn_t *R_GetPatchColumnWrapped(const rpatch_t *patch, int columnIndex)
 {
     while (columnIndex < 0)
@@ -78,6 +78,22 @@ const rpatch_t *R_CacheTextureCompositePatchNum(int id);
 const rcolumn_t *R_GetPatchColumnWrapped(const rpatch_t *patch, int columnIndex);
 const rcolumn_t *R_GetPatchColumnClamped(const rpatch_t *patch, int columnIndex);
 
+typedef enum
+{
+    PRECACHE_FLAT,
+    PRECACHE_TEXTURE,
+    PRECACHE_SPRITE
+} precachetype_t;
+
+typedef struct
+{
+    precachetype_t  type;
+    int             id;
+} precache_t;
+
 void R_InitPatches(void);
+void R_PrecachePatches(precache_t *list, int count);
+void R_WaitForPrecache(dboolean cancel);
+void R_FreeTextureComposites(void);
 
 #endif
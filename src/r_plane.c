@@ -47,58 +47,58 @@
 
 #define MAXVISPLANES    128                     // must be a power of 2
 
-static visplane_t   *visplanes[MAXVISPLANES];   // killough
-static visplane_t   *freetail;                  // killough
-static visplane_t   **freehead = &freetail;     // killough
-visplane_t          *floorplane;
-visplane_t          *ceilingplane;
+static THREADLOCAL visplane_t   *visplanes[MAXVISPLANES];   // killough
+static THREADLOCAL visplane_t   *freetail;                  // killough
+static THREADLOCAL visplane_t   **freehead;                 // killough
+THREADLOCAL visplane_t          *floorplane;
+THREADLOCAL visplane_t          *ceilingplane;
 
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
 #define visplane_hash(picnum, lightlevel, height) \
     ((unsigned int)((picnum) * 3 + (lightlevel) + (height) * 7) & (MAXVISPLANES - 1))
 
-int                 *openings;                  // dropoff overflow
-int                 *lastopening;               // dropoff overflow
+THREADLOCAL int                 *openings;                  // dropoff overflow
+THREADLOCAL int                 *lastopening;               // dropoff overflow
 
 // Clip values are the solid pixel bounding the range.
 //  floorclip starts out SCREENHEIGHT
 //  ceilingclip starts out -1
-int                 floorclip[SCREENWIDTH];     // dropoff overflow
-int                 ceilingclip[SCREENWIDTH];   // dropoff overflow
+THREADLOCAL int                 floorclip[SCREENWIDTH];     // dropoff overflow
+THREADLOCAL int                 ceilingclip[SCREENWIDTH];   // dropoff overflow
 
 // texture mapping
-static lighttable_t **planezlight;
-static fixed_t      planeheight;
+static THREADLOCAL lighttable_t **planezlight;
+static THREADLOCAL fixed_t      planeheight;
 
-static fixed_t      xoffset, yoffset;           // killough 2/28/98: flat offsets
+static THREADLOCAL fixed_t      xoffset, yoffset;           // killough 2/28/98: flat offsets
 
-fixed_t             *yslope;
-fixed_t             yslopes[LOOKDIRS][SCREENHEIGHT];
+fixed_t                         *yslope;
+fixed_t                         yslopes[LOOKDIRS][SCREENHEIGHT];
 
-static fixed_t      cachedheight[SCREENHEIGHT];
+static THREADLOCAL fixed_t      cachedheight[SCREENHEIGHT];
 
-dboolean            r_liquid_current = r_liquid_current_default;
-dboolean            r_liquid_swirl = r_liquid_swirl_default;
+dboolean                        r_liquid_current = r_liquid_current_default;
+dboolean                        r_liquid_swirl = r_liquid_swirl_default;
 
-extern fixed_t      animatedliquidxoffs;
-extern fixed_t      animatedliquidyoffs;
-extern dboolean     canmouselook;
+extern fixed_t                  animatedliquidxoffs;
+extern fixed_t                  animatedliquidyoffs;
+extern dboolean                 canmouselook;
 
 //
 // R_MapPlane
 //
 static void R_MapPlane(int y, int x1, int x2)
 {
-    static fixed_t  cacheddistance[SCREENHEIGHT];
-    static fixed_t  cachedviewcosdistance[SCREENHEIGHT];
-    static fixed_t  cachedviewsindistance[SCREENHEIGHT];
-    static fixed_t  cachedxstep[SCREENHEIGHT];
-    static fixed_t  cachedystep[SCREENHEIGHT];
-    fixed_t         distance;
-    fixed_t         viewcosdistance;
-    fixed_t         viewsindistance;
-    int             dx;
+    static THREADLOCAL fixed_t  cacheddistance[SCREENHEIGHT];
+    static THREADLOCAL fixed_t  cachedviewcosdistance[SCREENHEIGHT];
+    static THREADLOCAL fixed_t  cachedviewsindistance[SCREENHEIGHT];
+    static THREADLOCAL fixed_t  cachedxstep[SCREENHEIGHT];
+    static THREADLOCAL fixed_t  cachedystep[SCREENHEIGHT];
+    fixed_t                     distance;
+    fixed_t                     viewcosdistance;
+    fixed_t                     viewsindistance;
+    int                         dx;
 
     if (planeheight != cachedheight[y])
     {
@@ -149,6 +149,9 @@ void R_ClearPlanes(void)
         ceilingclip[i] = -1;
     }
 
+    if (!freehead)
+        freehead = &freetail;
+
     for (int i = 0; i < MAXVISPLANES; i++)
         for (*freehead = visplanes[i], visplanes[i] = NULL; *freehead;)
             freehead = &(*freehead)->next;
@@ -283,8 +286,8 @@ static void R_MakeSpans(visplane_t *pl)
 {
     // spanstart holds the start of a plane span
     // initialized to 0 at start
-    static int  spanstart[SCREENHEIGHT];
-    int         stop = pl->right + 1;
+    static THREADLOCAL int  spanstart[SCREENHEIGHT];
+    int                     stop = pl->right + 1;
 
     if (terraintypes[pl->picnum] != SOLID && r_liquid_current)
     {
@@ -344,11 +347,11 @@ static int  offsets[1024 * 4096];
 //
 static byte *R_DistortedFlat(int flatnum)
 {
-    static byte distortedflat[4096];
-    static int  prevleveltime = -1;
-    static int  prevflatnum = -1;
-    static byte *normalflat;
-    static int  *offset;
+    static THREADLOCAL byte distortedflat[4096];
+    static THREADLOCAL int  prevleveltime = -1;
+    static THREADLOCAL int  prevflatnum = -1;
+    static THREADLOCAL byte *normalflat;
+    static THREADLOCAL int  *offset;
 
     if (prevleveltime != leveltime)
     {
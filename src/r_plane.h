@@ -43,12 +43,12 @@
 #define PL_SKYFLAT  0x40000000
 
 // Visplane related.
-extern int      *lastopening;
-extern int      floorclip[SCREENWIDTH];
-extern int      ceilingclip[SCREENWIDTH];
-extern fixed_t  *yslope;
-extern fixed_t  yslopes[LOOKDIRS][SCREENHEIGHT];
-extern int      *openings;  // dropoff overflow
+extern THREADLOCAL int  *lastopening;
+extern THREADLOCAL int  floorclip[SCREENWIDTH];
+extern THREADLOCAL int  ceilingclip[SCREENWIDTH];
+extern fixed_t          *yslope;
+extern fixed_t          yslopes[LOOKDIRS][SCREENHEIGHT];
+extern THREADLOCAL int  *openings;  // dropoff overflow
 
 void R_ClearPlanes(void);
 void R_DrawPlanes(void);
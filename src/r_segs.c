@@ -43,62 +43,66 @@
 #include "m_config.h"
 #include "p_local.h"
 
-static dboolean     segtextured;        // True if any of the segs textures might be visible.
+static THREADLOCAL dboolean     segtextured;        // True if any of the segs textures might be visible.
 
-static dboolean     markfloor;          // False if the back side is the same plane.
-static dboolean     markceiling;
+static THREADLOCAL dboolean     markfloor;          // False if the back side is the same plane.
+static THREADLOCAL dboolean     markceiling;
 
-static dboolean     maskedtexture;
-static int          toptexture;
-static int          midtexture;
-static int          bottomtexture;
+static THREADLOCAL dboolean     maskedtexture;
+static THREADLOCAL int          toptexture;
+static THREADLOCAL int          midtexture;
+static THREADLOCAL int          bottomtexture;
 
-static dboolean     missingtoptexture;
-static dboolean     missingmidtexture;
-static dboolean     missingbottomtexture;
+static THREADLOCAL dboolean     missingtoptexture;
+static THREADLOCAL dboolean     missingmidtexture;
+static THREADLOCAL dboolean     missingbottomtexture;
 
-static fixed_t      toptexheight;
-static fixed_t      midtexheight;
-static fixed_t      bottomtexheight;
+static THREADLOCAL fixed_t      toptexheight;
+static THREADLOCAL fixed_t      midtexheight;
+static THREADLOCAL fixed_t      bottomtexheight;
 
-static byte         *topbrightmap;
-static byte         *midbrightmap;
-static byte         *bottombrightmap;
+static THREADLOCAL byte         *topbrightmap;
+static THREADLOCAL byte         *midbrightmap;
+static THREADLOCAL byte         *bottombrightmap;
 
-static angle_t      rw_normalangle;
-static fixed_t      rw_distance;
+static THREADLOCAL angle_t      rw_normalangle;
+static THREADLOCAL fixed_t      rw_distance;
 
 //
 // regular wall
 //
-static int          rw_x;
-static int          rw_stopx;
-static angle_t      rw_centerangle;
-static fixed_t      rw_offset;
-static fixed_t      rw_scale;
-static fixed_t      rw_scalestep;
-static fixed_t      rw_midtexturemid;
-static fixed_t      rw_toptexturemid;
-static fixed_t      rw_bottomtexturemid;
+static THREADLOCAL int          rw_x;
+static THREADLOCAL int          rw_stopx;
+static THREADLOCAL angle_t      rw_centerangle;
+static THREADLOCAL fixed_t      rw_offset;
+static THREADLOCAL fixed_t      rw_scale;
+static THREADLOCAL fixed_t      rw_scalestep;
+static THREADLOCAL fixed_t      rw_midtexturemid;
+static THREADLOCAL fixed_t      rw_toptexturemid;
+static THREADLOCAL fixed_t      rw_bottomtexturemid;
 
-static int64_t      pixhigh;
-static int64_t      pixlow;
-static fixed_t      pixhighstep;
-static fixed_t      pixlowstep;
+static THREADLOCAL int64_t      pixhigh;
+static THREADLOCAL int64_t      pixlow;
+static THREADLOCAL fixed_t      pixhighstep;
+static THREADLOCAL fixed_t      pixlowstep;
 
-static int64_t      topfrac;
-static fixed_t      topstep;
+static THREADLOCAL int64_t      topfrac;
+static THREADLOCAL fixed_t      topstep;
 
-static int64_t      bottomfrac;
-static fixed_t      bottomstep;
+static THREADLOCAL int64_t      bottomfrac;
+static THREADLOCAL fixed_t      bottomstep;
 
-lighttable_t        **walllights;
+THREADLOCAL lighttable_t        **walllights;
 
-static int          *maskedtexturecol;  // dropoff overflow
+static THREADLOCAL int          *maskedtexturecol;  // dropoff overflow
 
-dboolean            r_brightmaps = r_brightmaps_default;
+static THREADLOCAL int          segtexturecol[SCREENWIDTH];
+static THREADLOCAL fixed_t      segiscale[SCREENWIDTH];
+static THREADLOCAL lighttable_t *seglights[SCREENWIDTH];
 
-extern dboolean     usebrightmaps;
+dboolean                        r_brightmaps = r_brightmaps_default;
+
+extern dboolean                 usebrightmaps;
 
 //
 // R_FixWiggle()
@@ -139,10 +143,15 @@ extern dboolean     usebrightmaps;
 //   increasing the precision of various renderer variables, and,
 //   possibly, creating a noticeable performance penalty.
 //
-static int  max_rwscale = 64 * FRACUNIT;
-static int  heightbits = 12;
-static int  heightunit = (1 << 12);
-static int  invhgtbits = 4;
+//  The values are cached per thread against the height they were last
+//   calculated for, rather than in the sector, so that strips of the view
+//   rendered in parallel don't pick up each other's values.
+//
+static THREADLOCAL int  max_rwscale = 64 * FRACUNIT;
+static THREADLOCAL int  heightbits = 12;
+static THREADLOCAL int  heightunit = (1 << 12);
+static THREADLOCAL int  invhgtbits = 4;
+static THREADLOCAL int  cachedheight;
 
 static void R_FixWiggle(sector_t *sector)
 {
@@ -150,7 +159,7 @@ static void R_FixWiggle(sector_t *sector)
     int height = MAX(1, (sector->interpceilingheight - sector->interpfloorheight) >> FRACBITS);
 
     // initialize, or handle moving sector
-    if (height != sector->cachedheight)
+    if (height != cachedheight)
     {
         typedef struct
         {
@@ -168,7 +177,7 @@ static void R_FixWiggle(sector_t *sector)
         int                 scaleindex = 0;
         const scalevalues_t *scalevalue;
 
-        sector->cachedheight = height;
+        cachedheight = height;
         height >>= 7;
 
         // calculate adjustment
@@ -293,19 +302,59 @@ void R_RenderMaskedSegRange(drawseg_t *ds, const int x1, const int x2)
         }
 }
 
+//
+// R_CalcSegColumns
+// Calculates the texture column, scale and lighting of every column of a seg before any of
+// them are drawn, in loops with no dependencies between columns, so R_RenderSegLoop() does
+// no divides or table lookups of its own.
+//
+static void R_CalcSegColumns(void)
+{
+    fixed_t scale = rw_scale;
+
+    for (int x = rw_x; x < rw_stopx; x++)
+    {
+        const angle_t   angle = MIN((rw_centerangle + xtoviewangle[x]) >> ANGLETOFINESHIFT, FINEANGLES / 2 - 1);
+
+        segtexturecol[x] = (rw_offset - FixedMul(finetangent[angle], rw_distance)) >> FRACBITS;
+        segiscale[x] = UINT_MAX / scale;
+        scale += rw_scalestep;
+    }
+
+    if (!fixedcolormap)
+    {
+        scale = rw_scale;
+
+        for (int x = rw_x; x < rw_stopx; x++)
+        {
+            seglights[x] = walllights[MIN(scale >> LIGHTSCALESHIFT, MAXLIGHTSCALE - 1)];
+            scale += rw_scalestep;
+        }
+    }
+}
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked texture) for walls.
 // Can draw or mark the starting pixel of floor and ceiling textures.
 // CALLED: CORE LOOPING ROUTINE.
 //
-static dboolean didsolidcol;
+static THREADLOCAL dboolean didsolidcol;
 
 static void R_RenderSegLoop(void)
 {
+    // the textures are the same for every column of the seg
+    const rpatch_t  *toppatch = (toptexture && !missingtoptexture ? R_CacheTextureCompositePatchNum(toptexture) : NULL);
+    const rpatch_t  *midpatch = (midtexture && !missingmidtexture ? R_CacheTextureCompositePatchNum(midtexture) : NULL);
+    const rpatch_t  *bottompatch = (bottomtexture && !missingbottomtexture ?
+                        R_CacheTextureCompositePatchNum(bottomtexture) : NULL);
+
     if (fixedcolormap)
         dc_colormap[0] = fixedcolormap;
 
+    if (segtextured)
+        R_CalcSegColumns();
+
     for (; rw_x < rw_stopx; rw_x++)
     {
         fixed_t texturecolumn = 0;
@@ -346,16 +395,13 @@ static void R_RenderSegLoop(void)
         // texturecolumn and lighting are independent of wall tiers
         if (segtextured)
         {
-            // calculate texture offset and lighting
-            const angle_t   angle = MIN((rw_centerangle + xtoviewangle[rw_x]) >> ANGLETOFINESHIFT, FINEANGLES / 2 - 1);
-
-            texturecolumn = (rw_offset - FixedMul(finetangent[angle], rw_distance)) >> FRACBITS;
+            texturecolumn = segtexturecol[rw_x];
 
             if (!fixedcolormap)
-                dc_colormap[0] = walllights[MIN(rw_scale >> LIGHTSCALESHIFT, MAXLIGHTSCALE - 1)];
+                dc_colormap[0] = seglights[rw_x];
 
             dc_x = rw_x;
-            dc_iscale = UINT_MAX / rw_scale;
+            dc_iscale = segiscale[rw_x];
         }
 
         // draw the wall tiers
@@ -369,9 +415,10 @@ static void R_RenderSegLoop(void)
                 R_DrawColorColumn();
             else
             {
-                dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(midtexture), texturecolumn);
+                dc_source = R_GetTextureColumn(midpatch, texturecolumn);
                 dc_texturemid = rw_midtexturemid;
                 dc_texheight = midtexheight;
+                dc_batch = MIDWALLBATCH;
 
                 if (midbrightmap)
                 {
@@ -404,10 +451,11 @@ static void R_RenderSegLoop(void)
                         R_DrawColorColumn();
                     else
                     {
-                        dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(toptexture), texturecolumn);
+                        dc_source = R_GetTextureColumn(toppatch, texturecolumn);
                         dc_texturemid = rw_toptexturemid + (dc_yl - centery + 1) * SPARKLEFIX;
                         dc_iscale -= SPARKLEFIX;
                         dc_texheight = toptexheight;
+                        dc_batch = TOPWALLBATCH;
 
                         if (topbrightmap)
                         {
@@ -444,9 +492,10 @@ static void R_RenderSegLoop(void)
                         R_DrawColorColumn();
                     else
                     {
-                        dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(bottomtexture), texturecolumn);
+                        dc_source = R_GetTextureColumn(bottompatch, texturecolumn);
                         dc_texturemid = rw_bottomtexturemid;
                         dc_texheight = bottomtexheight;
+                        dc_batch = BOTTOMWALLBATCH;
 
                         if (bottombrightmap)
                         {
@@ -480,10 +529,11 @@ static void R_RenderSegLoop(void)
                 maskedtexturecol[rw_x] = texturecolumn;
         }
 
-        rw_scale += rw_scalestep;
         topfrac += topstep;
         bottomfrac += bottomstep;
     }
+
+    R_FlushWallColumns();
 }
 
 //
@@ -506,15 +556,15 @@ static fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
 //
 void R_StoreWallRange(const int start, const int stop)
 {
-    int64_t             dx, dy;
-    int64_t             dx1, dy1;
-    int64_t             len;
-    int                 worldtop;
-    int                 worldbottom;
-    int                 worldhigh = 0;
-    int                 worldlow = 0;
-    side_t              *sidedef;
-    static unsigned int maxdrawsegs;
+    int64_t                         dx, dy;
+    int64_t                         dx1, dy1;
+    int64_t                         len;
+    int                             worldtop;
+    int                             worldbottom;
+    int                             worldhigh = 0;
+    int                             worldlow = 0;
+    side_t                          *sidedef;
+    static THREADLOCAL unsigned int maxdrawsegs;
 
     linedef = curline->linedef;
 
@@ -556,9 +606,9 @@ void R_StoreWallRange(const int start, const int stop)
 
     // killough 1/6/98, 2/1/98: remove limit on openings
     {
-        const size_t    pos = lastopening - openings;
-        const size_t    need = ((size_t)rw_stopx - start) * sizeof(*lastopening) + pos;
-        static size_t   maxopenings;
+        const size_t                pos = lastopening - openings;
+        const size_t                need = ((size_t)rw_stopx - start) * sizeof(*lastopening) + pos;
+        static THREADLOCAL size_t   maxopenings;
 
         if (need > maxopenings)
         {
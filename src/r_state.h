@@ -115,7 +115,8 @@ typedef enum
 {
     DOOMBSP,
     DEEPBSP,
-    ZDBSPX
+    ZDBSPX,
+    BUILTNODES
 } mapformat_t;
 
 extern mapformat_t  mapformat;
@@ -141,7 +142,7 @@ extern angle_t      clipangle;
 extern int          viewangletox[FINEANGLES / 2];
 extern angle_t      xtoviewangle[SCREENWIDTH + 1];
 
-extern visplane_t   *floorplane;
-extern visplane_t   *ceilingplane;
+extern THREADLOCAL visplane_t   *floorplane;
+extern THREADLOCAL visplane_t   *ceilingplane;
 
 #endif
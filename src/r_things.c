@@ -61,7 +61,7 @@
 fixed_t                 pspritescale;
 fixed_t                 pspriteiscale;
 
-static lighttable_t     **spritelights;         // killough 1/25/98 made static
+static THREADLOCAL lighttable_t **spritelights;     // killough 1/25/98 made static
 
 // constant arrays used for psprite clipping and initializing clipping
 int                     negonearray[SCREENWIDTH];
@@ -79,11 +79,11 @@ short                   firstbloodsplatlump;
 static spriteframe_t    sprtemp[MAX_SPRITE_FRAMES];
 static int              maxframe;
 
-static dboolean         drawshadows;
-static dboolean         interpolatesprites;
-static dboolean         invulnerable;
-static dboolean         pausesprites;
-static fixed_t          floorheight;
+static THREADLOCAL dboolean drawshadows;
+static THREADLOCAL dboolean interpolatesprites;
+static THREADLOCAL dboolean invulnerable;
+static THREADLOCAL dboolean pausesprites;
+static THREADLOCAL fixed_t  floorheight;
 
 dboolean                r_liquid_clipsprites = r_liquid_clipsprites_default;
 dboolean                r_playersprites = r_playersprites_default;
@@ -293,13 +293,14 @@ static void R_InitSpriteDefs(void)
 // GAME FUNCTIONS
 //
 
-static vissprite_t              *vissprites;
-static vissprite_t              **vissprite_ptrs;
-static unsigned int             num_vissprite;
-static unsigned int             num_bloodsplatvissprite;
-static unsigned int             num_vissprite_alloc = MAXVISSPRITES;
+static THREADLOCAL vissprite_t              *vissprites;
+static THREADLOCAL vissprite_t              **vissprite_ptrs;
+static THREADLOCAL unsigned int             num_vissprite;
+static THREADLOCAL unsigned int             num_vissprite_alloc;
 
-static bloodsplatvissprite_t    bloodsplatvissprites[r_bloodsplats_max_max];
+static THREADLOCAL bloodsplatvissprite_t    *bloodsplatvissprites;
+static THREADLOCAL unsigned int             num_bloodsplatvissprite;
+static THREADLOCAL unsigned int             num_bloodsplatvissprite_alloc;
 
 //
 // R_InitSprites
@@ -311,8 +312,6 @@ void R_InitSprites(void)
         negonearray[i] = -1;
 
     R_InitSpriteDefs();
-
-    vissprites = malloc(num_vissprite_alloc * sizeof(*vissprites));
 }
 
 //
@@ -339,16 +338,30 @@ static vissprite_t *R_NewVisSprite(void)
     return (vissprites + num_vissprite++);
 }
 
-int             *mfloorclip;
-int             *mceilingclip;
+//
+// R_NewBloodSplatVisSprite
+//
+static bloodsplatvissprite_t *R_NewBloodSplatVisSprite(void)
+{
+    if (num_bloodsplatvissprite >= num_bloodsplatvissprite_alloc)
+    {
+        num_bloodsplatvissprite_alloc = (num_bloodsplatvissprite_alloc ? num_bloodsplatvissprite_alloc * 2 : MAXVISSPRITES);
+        bloodsplatvissprites = I_Realloc(bloodsplatvissprites, num_bloodsplatvissprite_alloc * sizeof(*bloodsplatvissprites));
+    }
 
-fixed_t         spryscale;
-int64_t         sprtopscreen;
-static int64_t  shadowtopscreen;
-static int64_t  shadowshift;
-int             fuzzpos;
+    return (bloodsplatvissprites + num_bloodsplatvissprite++);
+}
 
-static void (*shadowcolfunc)(void);
+THREADLOCAL int             *mfloorclip;
+THREADLOCAL int             *mceilingclip;
+
+THREADLOCAL fixed_t         spryscale;
+THREADLOCAL int64_t         sprtopscreen;
+static THREADLOCAL int64_t  shadowtopscreen;
+static THREADLOCAL int64_t  shadowshift;
+THREADLOCAL int             fuzzpos;
+
+static THREADLOCAL void (*shadowcolfunc)(void);
 
 static void R_BlastShadowColumn(const rcolumn_t *column)
 {
@@ -672,11 +685,11 @@ static void R_ProjectSprite(mobj_t *thing)
     tx -= (flip ? width - offset : offset);
 
     // off the right side?
-    if ((x1 = (centerxfrac + FixedMul(tx, xscale)) >> FRACBITS) >= viewwidth)
+    if ((x1 = (centerxfrac + FixedMul(tx, xscale)) >> FRACBITS) > stripx2)
         return;
 
     // off the left side
-    if ((x2 = ((centerxfrac + FixedMul(tx + width, xscale) - FRACUNIT / 2) >> FRACBITS)) < 0)
+    if ((x2 = ((centerxfrac + FixedMul(tx + width, xscale) - FRACUNIT / 2) >> FRACBITS)) < stripx1)
         return;
 
     // quickly reject sprites with bad x ranges
@@ -748,10 +761,10 @@ static void R_ProjectSprite(mobj_t *thing)
     {
         vis->xiscale = -FixedDiv(FRACUNIT, xscale);
 
-        if (x1 < 0)
+        if (x1 < stripx1)
         {
-            vis->x1 = 0;
-            vis->startfrac = width - 1 - vis->xiscale * x1;
+            vis->x1 = stripx1;
+            vis->startfrac = width - 1 + vis->xiscale * (stripx1 - x1);
         }
         else
         {
@@ -763,10 +776,10 @@ static void R_ProjectSprite(mobj_t *thing)
     {
         vis->xiscale = FixedDiv(FRACUNIT, xscale);
 
-        if (x1 < 0)
+        if (x1 < stripx1)
         {
-            vis->x1 = 0;
-            vis->startfrac = -vis->xiscale * x1;
+            vis->x1 = stripx1;
+            vis->startfrac = vis->xiscale * (stripx1 - x1);
         }
         else
         {
@@ -775,7 +788,7 @@ static void R_ProjectSprite(mobj_t *thing)
         }
     }
 
-    vis->x2 = MIN(x2, viewwidth - 1);
+    vis->x2 = MIN(x2, stripx2);
     vis->patch = lump;
 
     // get light level
@@ -819,11 +832,11 @@ static void R_ProjectBloodSplat(const bloodsplat_t *splat)
     tx -= (width >> 1);
 
     // off the right side?
-    if ((x1 = (centerxfrac + FRACUNIT / 2 + FixedMul(tx, xscale)) >> FRACBITS) >= viewwidth)
+    if ((x1 = (centerxfrac + FRACUNIT / 2 + FixedMul(tx, xscale)) >> FRACBITS) > stripx2)
         return;
 
     // off the left side
-    if ((x2 = ((centerxfrac + FRACUNIT / 2 + FixedMul(tx + width, xscale)) >> FRACBITS) - 1) < 0)
+    if ((x2 = ((centerxfrac + FRACUNIT / 2 + FixedMul(tx + width, xscale)) >> FRACBITS) - 1) < stripx1)
         return;
 
     // quickly reject sprites with bad x ranges
@@ -831,7 +844,7 @@ static void R_ProjectBloodSplat(const bloodsplat_t *splat)
         return;
 
     // store information in a vissprite
-    vis = &bloodsplatvissprites[num_bloodsplatvissprite++];
+    vis = R_NewBloodSplatVisSprite();
 
     vis->scale = xscale;
     vis->gx = fx;
@@ -859,10 +872,10 @@ static void R_ProjectBloodSplat(const bloodsplat_t *splat)
     {
         vis->xiscale = -FixedDiv(FRACUNIT, xscale);
 
-        if (x1 < 0)
+        if (x1 < stripx1)
         {
-            vis->x1 = 0;
-            vis->startfrac = width - 1 - vis->xiscale * x1;
+            vis->x1 = stripx1;
+            vis->startfrac = width - 1 + vis->xiscale * (stripx1 - x1);
         }
         else
         {
@@ -874,10 +887,10 @@ static void R_ProjectBloodSplat(const bloodsplat_t *splat)
     {
         vis->xiscale = FixedDiv(FRACUNIT, xscale);
 
-        if (x1 < 0)
+        if (x1 < stripx1)
         {
-            vis->x1 = 0;
-            vis->startfrac = -vis->xiscale * x1;
+            vis->x1 = stripx1;
+            vis->startfrac = vis->xiscale * (stripx1 - x1);
         }
         else
         {
@@ -886,7 +899,7 @@ static void R_ProjectBloodSplat(const bloodsplat_t *splat)
         }
     }
 
-    vis->x2 = MIN(x2, viewwidth - 1);
+    vis->x2 = MIN(x2, stripx2);
     vis->patch = splat->patch;
 
     // get light level
@@ -1114,6 +1127,94 @@ void R_DrawPlayerSprites(void)
     }
 }
 
+//
+// Drawseg buckets
+// Rather than each sprite scanning every drawseg, those drawsegs that can clip sprites (that
+// is, those with a silhouette or a masked mid texture) are put into buckets of columns after
+// the BSP has been rendered. The buckets at each level are twice as wide as the distance
+// between them, so any sprite no wider than that distance lies entirely within one bucket,
+// which lists only those drawsegs that overlap it, in the same order they would be scanned.
+//
+#define DSBUCKETSHIFT       4
+#define NUMDSBUCKETLEVELS   8
+#define NUMDSBUCKETS        (SCREENWIDTH / (1 << (DSBUCKETSHIFT - 1)) + NUMDSBUCKETLEVELS)
+
+static THREADLOCAL int          dsbucketoffsets[NUMDSBUCKETS + 1];
+static THREADLOCAL drawseg_t    **dsbucketsegs;
+static THREADLOCAL int          dsbucketsegs_alloc;
+
+THREADLOCAL int                 spritesclipped;
+THREADLOCAL int                 clipsegsvisited;
+
+static int R_DrawSegBucketLevel(const int level)
+{
+    int bucket = 0;
+
+    for (int i = 0; i < level; i++)
+        bucket += ((SCREENWIDTH - 1) >> (DSBUCKETSHIFT + i)) + 1;
+
+    return bucket;
+}
+
+static void R_BucketDrawSegs(void)
+{
+    int total;
+
+    memset(dsbucketoffsets, 0, sizeof(dsbucketoffsets));
+
+    // count the drawsegs in each bucket
+    for (drawseg_t *ds = ds_p; ds-- > drawsegs;)
+        if (ds->silhouette || ds->maskedtexturecol)
+            for (int level = 0, bucket = 0; level < NUMDSBUCKETLEVELS; level++)
+            {
+                const int   shift = DSBUCKETSHIFT + level;
+
+                for (int i = MAX(0, (ds->x1 >> shift) - 1); i <= (ds->x2 >> shift); i++)
+                    dsbucketoffsets[bucket + i + 1]++;
+
+                bucket += ((SCREENWIDTH - 1) >> shift) + 1;
+            }
+
+    for (int i = 1; i <= NUMDSBUCKETS; i++)
+        dsbucketoffsets[i] += dsbucketoffsets[i - 1];
+
+    if ((total = dsbucketoffsets[NUMDSBUCKETS]) > dsbucketsegs_alloc)
+        dsbucketsegs = I_Realloc(dsbucketsegs, (dsbucketsegs_alloc = total * 2) * sizeof(*dsbucketsegs));
+
+    // then fill them, leaving each offset at the end of its bucket
+    for (drawseg_t *ds = ds_p; ds-- > drawsegs;)
+        if (ds->silhouette || ds->maskedtexturecol)
+            for (int level = 0, bucket = 0; level < NUMDSBUCKETLEVELS; level++)
+            {
+                const int   shift = DSBUCKETSHIFT + level;
+
+                for (int i = MAX(0, (ds->x1 >> shift) - 1); i <= (ds->x2 >> shift); i++)
+                    dsbucketsegs[dsbucketoffsets[bucket + i]++] = ds;
+
+                bucket += ((SCREENWIDTH - 1) >> shift) + 1;
+            }
+
+    memmove(dsbucketoffsets + 1, dsbucketoffsets, NUMDSBUCKETS * sizeof(*dsbucketoffsets));
+    dsbucketoffsets[0] = 0;
+}
+
+static int R_GetDrawSegBucket(const int x1, const int x2, drawseg_t ***segs)
+{
+    int level = 0;
+    int bucket;
+
+    while (((x2 >> (DSBUCKETSHIFT + level)) - (x1 >> (DSBUCKETSHIFT + level))) > 1)
+        level++;
+
+    bucket = R_DrawSegBucketLevel(level) + (x1 >> (DSBUCKETSHIFT + level));
+    *segs = dsbucketsegs + dsbucketoffsets[bucket];
+
+    spritesclipped++;
+    clipsegsvisited += dsbucketoffsets[bucket + 1] - dsbucketoffsets[bucket];
+
+    return (dsbucketoffsets[bucket + 1] - dsbucketoffsets[bucket]);
+}
+
 //
 // R_DrawBloodSplatSprite
 //
@@ -1126,6 +1227,8 @@ static void R_DrawBloodSplatSprite(const bloodsplatvissprite_t *splat)
     const fixed_t   scale = splat->scale;
     const fixed_t   gx = splat->gx;
     const fixed_t   gy = splat->gy;
+    drawseg_t       **segs;
+    const int       numsegs = R_GetDrawSegBucket(x1, x2, &segs);
 
     // initialize the clipping arrays
     for (int i = x1; i <= x2; i++)
@@ -1136,9 +1239,10 @@ static void R_DrawBloodSplatSprite(const bloodsplatvissprite_t *splat)
 
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale is the clip seg.
-    for (drawseg_t *ds = ds_p; ds-- > drawsegs;)
+    for (int j = 0; j < numsegs; j++)
     {
-        const int   silhouette = ds->silhouette;
+        const drawseg_t *ds = segs[j];
+        const int       silhouette = ds->silhouette;
 
         // determine if the drawseg obscures the bloodsplat
         if (ds->x1 > x2 || ds->x2 < x1 || (!silhouette && !ds->maskedtexturecol))
@@ -1212,7 +1316,7 @@ static void R_SortVisSprites(void)
 {
     if (num_vissprite)
     {
-        static unsigned int num_vissprite_ptrs;
+        static THREADLOCAL unsigned int num_vissprite_ptrs;
 
         if (num_vissprite_ptrs < num_vissprite * 2)
             vissprite_ptrs = I_Realloc(vissprite_ptrs, (num_vissprite_ptrs = num_vissprite_alloc * 2) * sizeof(*vissprite_ptrs));
@@ -1233,6 +1337,8 @@ static void R_DrawSprite(const vissprite_t *spr)
     const fixed_t   scale = spr->scale;
     const fixed_t   gx = spr->gx;
     const fixed_t   gy = spr->gy;
+    drawseg_t       **segs;
+    const int       numsegs = R_GetDrawSegBucket(x1, x2, &segs);
 
     // initialize the clipping arrays
     for (int i = x1; i <= x2; i++)
@@ -1243,8 +1349,9 @@ static void R_DrawSprite(const vissprite_t *spr)
 
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale is the clip seg.
-    for (drawseg_t *ds = ds_p; ds-- > drawsegs;)
+    for (int j = 0; j < numsegs; j++)
     {
+        drawseg_t   *ds = segs[j];
         const int   silhouette = ds->silhouette;
 
         // determine if the drawseg obscures the sprite
@@ -1345,6 +1452,10 @@ void R_DrawMasked(void)
     pausesprites = (menuactive || paused || consoleactive || freeze);
     interpolatesprites = (vid_capfps != TICRATE && !pausesprites);
     invulnerable = (viewplayer->fixedcolormap == INVERSECOLORMAP && r_translucency);
+    spritesclipped = 0;
+    clipsegsvisited = 0;
+
+    R_BucketDrawSegs();
 
     // draw all blood splats
     i = num_bloodsplatvissprite;
@@ -1364,8 +1475,4 @@ void R_DrawMasked(void)
     for (drawseg_t *ds = ds_p; ds-- > drawsegs;)
         if (ds->maskedtexturecol)
             R_RenderMaskedSegRange(ds, ds->x1, ds->x2);
-
-    // draw the psprites on top of everything
-    if (r_playersprites && !inhelpscreens && (!menuactive || consoleactive))
-        R_DrawPlayerSprites();
 }
@@ -45,16 +45,19 @@ extern int      negonearray[SCREENWIDTH];
 extern int      viewheightarray[SCREENWIDTH];
 
 // vars for R_DrawMaskedColumn
-extern int      *mfloorclip;
-extern int      *mceilingclip;
-extern fixed_t  spryscale;
-extern int64_t  sprtopscreen;
+extern THREADLOCAL int      *mfloorclip;
+extern THREADLOCAL int      *mceilingclip;
+extern THREADLOCAL fixed_t  spryscale;
+extern THREADLOCAL int64_t  sprtopscreen;
 
 extern fixed_t  pspritescale;
 extern fixed_t  pspriteiscale;
 
 extern dboolean r_playersprites;
 
+extern THREADLOCAL int  spritesclipped;
+extern THREADLOCAL int  clipsegsvisited;
+
 extern short    firstbloodsplatlump;
 
 void R_AddSprites(sector_t *sec, int lightlevel);
@@ -283,7 +283,7 @@ void S_StopSounds(void)
             S_StopChannel(cnum);
 }
 
-static int S_GetMusicNum(void)
+static int S_GetMusicNum(int episode, int map)
 {
     static int mnum;
 
@@ -304,17 +304,17 @@ static int S_GetMusicNum(void)
                 mus_ddtblu
             };
 
-            mnum = nmus[(s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : gamemap) - 1];
+            mnum = nmus[(s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : map) - 1];
         }
         else
-            mnum = mus_runnin + (s_randommusic ? M_RandomIntNoRepeat(1, 32, mnum) : gamemap) - 1;
+            mnum = mus_runnin + (s_randommusic ? M_RandomIntNoRepeat(1, 32, mnum) : map) - 1;
     }
     else
     {
-        if (gameepisode < 4)
-            mnum = mus_e1m1 + (s_randommusic ? M_RandomIntNoRepeat(1, 21, mnum) : (gameepisode - 1) * 9 + gamemap) - 1;
-        else if (gameepisode == 5 && sigil)
-            mnum = mus_e5m1 + (s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : gamemap) - 1;
+        if (episode < 4)
+            mnum = mus_e1m1 + (s_randommusic ? M_RandomIntNoRepeat(1, 21, mnum) : (episode - 1) * 9 + map) - 1;
+        else if (episode == 5 && sigil)
+            mnum = mus_e5m1 + (s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : map) - 1;
         else
         {
             int spmus[] =
@@ -331,7 +331,7 @@ static int S_GetMusicNum(void)
                 mus_e1m9    // Tim          E4M9
             };
 
-            mnum = spmus[(s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : gamemap) - 1];
+            mnum = spmus[(s_randommusic ? M_RandomIntNoRepeat(1, 9, mnum) : map) - 1];
         }
     }
 
@@ -348,7 +348,7 @@ void S_Start(void)
     // start new music for the level
     mus_paused = false;
 
-    S_ChangeMusic(S_GetMusicNum(), true, false, true);
+    S_ChangeMusic(S_GetMusicNum(gameepisode, gamemap), true, false, true);
 }
 
 // [crispy] removed map objects may finish their sounds
@@ -690,23 +690,11 @@ void S_ChangeMusic(int music_id, dboolean looping, dboolean allowrestart, dboole
         if (!serverMidiPlaying)
 #endif
         {
-            char    *filename = M_StringJoin(namebuf, ".mp3", NULL);
-            char    *path = M_TempFile(filename);
+            char    *temp = uppercase(namebuf);
 
-            if (M_WriteFile(path, music->data, W_LumpLength(music->lumpnum)))
-                handle = Mix_LoadMUS(path);
-
-            free(filename);
-            free(path);
-
-            if (!handle)
-            {
-                char    *temp = uppercase(namebuf);
-
-                C_Warning(1, "The <b>%s</b> music lump can't be played.", temp);
-                free(temp);
-                return;
-            }
+            C_Warning(1, "The <b>%s</b> music lump can't be played.", temp);
+            free(temp);
+            return;
         }
 
     music->handle = handle;
@@ -724,6 +712,32 @@ void S_ChangeMusic(int music_id, dboolean looping, dboolean allowrestart, dboole
     }
 }
 
+//
+// S_PrefetchMapMusic
+// Called during the intermission so the music for the next map is ready to play when it starts.
+//
+void S_PrefetchMapMusic(int episode, int map)
+{
+    int lumpnum;
+
+    if (nomusic || s_randommusic)
+        return;
+
+    if ((lumpnum = P_GetMapMusic((episode - 1) * 10 + map)) <= 0)
+    {
+        const musicinfo_t   *music = &S_music[S_GetMusicNum(episode, map)];
+        char                namebuf[9];
+
+        M_snprintf(namebuf, sizeof(namebuf), "d_%s", music->name);
+
+        if ((lumpnum = (music->lumpnum > 0 ? music->lumpnum : W_CheckNumForName(namebuf))) < 0)
+            return;
+    }
+
+    I_PrefetchSong(W_CacheLumpNum(lumpnum), W_LumpLength(lumpnum));
+    W_ReleaseLumpNum(lumpnum);
+}
+
 void S_StopMusic(void)
 {
     if (!mus_playing)
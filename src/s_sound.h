@@ -66,6 +66,7 @@ void I_SetMusicVolume(int volume);
 void I_PauseSong(void);
 void I_ResumeSong(void);
 void *I_RegisterSong(void *data, int size);
+void I_PrefetchSong(void *data, int size);
 void I_UnRegisterSong(void *handle);
 void I_PlaySong(void *handle, dboolean looping);
 void I_StopSong(void);
@@ -106,6 +107,9 @@ void S_StartMusic(int music_id);
 //  and set whether looping
 void S_ChangeMusic(int music_id, dboolean looping, dboolean allowrestart, dboolean mapstart);
 
+// Prepare the music for the next map during the intermission.
+void S_PrefetchMapMusic(int episode, int map);
+
 // Stops the music fer sure.
 void S_StopMusic(void);
 
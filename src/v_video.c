@@ -366,7 +366,7 @@ void V_DrawSpectreShadowPatch(int x, int y, patch_t *patch)
             byte    *dest = &desttop[((column->topdelta * DY / 10) >> FRACBITS) * SCREENWIDTH];
             int     count = ((column->length * DY / 10) >> FRACBITS) + 1;
 
-            if ((consoleactive && !fuzztable[fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = shadow[*dest];
 
             dest += SCREENWIDTH;
@@ -377,7 +377,7 @@ void V_DrawSpectreShadowPatch(int x, int y, patch_t *patch)
                 dest += SCREENWIDTH;
             }
 
-            if ((consoleactive && !fuzztable[fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = shadow[*dest];
 
             column = (column_t *)((byte *)column + column->length + 4);
@@ -406,7 +406,7 @@ void V_DrawSolidSpectreShadowPatch(int x, int y, patch_t *patch)
             byte    *dest = &desttop[((column->topdelta * DY / 10) >> FRACBITS) * SCREENWIDTH];
             int     count = ((column->length * DY / 10) >> FRACBITS) + 1;
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = nearestblack;
 
             dest += SCREENWIDTH;
@@ -417,7 +417,7 @@ void V_DrawSolidSpectreShadowPatch(int x, int y, patch_t *patch)
                 dest += SCREENWIDTH;
             }
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = nearestblack;
 
             column = (column_t *)((byte *)column + column->length + 4);
@@ -1135,7 +1135,7 @@ void V_DrawFlippedSpectreShadowPatch(int x, int y, patch_t *patch)
             byte    *dest = &desttop[((column->topdelta * DY / 10) >> FRACBITS) * SCREENWIDTH];
             int     count = ((column->length * DY / 10) >> FRACBITS) + 1;
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = shadow[*dest];
 
             dest += SCREENWIDTH;
@@ -1146,7 +1146,7 @@ void V_DrawFlippedSpectreShadowPatch(int x, int y, patch_t *patch)
                 dest += SCREENWIDTH;
             }
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = shadow[*dest];
 
             column = (column_t *)((byte *)column + column->length + 4);
@@ -1175,7 +1175,7 @@ void V_DrawFlippedSolidSpectreShadowPatch(int x, int y, patch_t *patch)
             byte    *dest = &desttop[((column->topdelta * DY / 10) >> FRACBITS) * SCREENWIDTH];
             int     count = ((column->length * DY / 10) >> FRACBITS) + 1;
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = nearestblack;
 
             dest += SCREENWIDTH;
@@ -1186,7 +1186,7 @@ void V_DrawFlippedSolidSpectreShadowPatch(int x, int y, patch_t *patch)
                 dest += SCREENWIDTH;
             }
 
-            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_Random() & 3)))
+            if ((consoleactive && !fuzztable[_fuzzpos++]) || (!consoleactive && !(M_CosmeticRandom() & 3)))
                 *dest = nearestblack;
 
             column = (column_t *)((byte *)column + column->length + 4);
@@ -1479,6 +1479,79 @@ void V_InvertScreen(void)
         }
 }
 
+//
+// V_BlurScreen
+//  blur the first height bytes of src into dest. The kernel is [1 2 2 2 1] / 8, applied across
+//  each row and then down each column, and is made only of 50% blends so it stays in the palette.
+//
+void V_BlurScreen(const byte *src, byte *dest, int height)
+{
+    static byte row1[SCREENWIDTH];
+    static byte row2[SCREENWIDTH];
+    byte        *above = row1;
+    byte        *current = row2;
+    const int   last = height - SCREENWIDTH;
+
+    // blend each pixel with its left and right neighbors, then blend the two results either side of it
+    for (int y = 0; y < height; y += SCREENWIDTH)
+    {
+        const byte  *in = src + y;
+        byte        *out = dest + y;
+
+        current[0] = tinttab50[(tinttab50[(in[0] << 8) + in[1]] << 8) + in[0]];
+
+        for (int x = 1; x < SCREENWIDTH - 1; x++)
+            current[x] = tinttab50[(tinttab50[(in[x - 1] << 8) + in[x + 1]] << 8) + in[x]];
+
+        current[SCREENWIDTH - 1] = tinttab50[(tinttab50[(in[SCREENWIDTH - 2] << 8) + in[SCREENWIDTH - 1]] << 8)
+            + in[SCREENWIDTH - 1]];
+
+        out[0] = tinttab50[(current[0] << 8) + current[1]];
+
+        for (int x = 1; x < SCREENWIDTH - 1; x++)
+            out[x] = tinttab50[(current[x - 1] << 8) + current[x + 1]];
+
+        out[SCREENWIDTH - 1] = tinttab50[(current[SCREENWIDTH - 2] << 8) + current[SCREENWIDTH - 1]];
+    }
+
+    // do the same with the pixels above and below, a row at a time, keeping the unblended row above
+    memcpy(above, dest, SCREENWIDTH);
+
+    for (int y = 0; y < height; y += SCREENWIDTH)
+    {
+        byte        *out = dest + y;
+        const byte  *below = (y < last ? out + SCREENWIDTH : out);
+        byte        *temp;
+
+        memcpy(current, out, SCREENWIDTH);
+
+        for (int x = 0; x < SCREENWIDTH; x++)
+            out[x] = tinttab50[(tinttab50[(above[x] << 8) + below[x]] << 8) + out[x]];
+
+        temp = above;
+        above = current;
+        current = temp;
+    }
+
+    memcpy(above, dest, SCREENWIDTH);
+
+    for (int y = 0; y < height; y += SCREENWIDTH)
+    {
+        byte        *out = dest + y;
+        const byte  *below = (y < last ? out + SCREENWIDTH : out);
+        byte        *temp;
+
+        memcpy(current, out, SCREENWIDTH);
+
+        for (int x = 0; x < SCREENWIDTH; x++)
+            out[x] = tinttab50[(above[x] << 8) + below[x]];
+
+        temp = above;
+        above = current;
+        current = temp;
+    }
+}
+
 //
 // V_Init
 //
@@ -96,6 +96,7 @@ void V_DrawPixel(int x, int y, byte color, dboolean drawshadow);
 void GetPixelSize(dboolean reset);
 void V_LowGraphicDetail(void);
 void V_InvertScreen(void);
+void V_BlurScreen(const byte *src, byte *dest, int height);
 
 dboolean V_ScreenShot(void);
 
@@ -36,10 +36,78 @@
 ========================================================================
 */
 
+#if defined(_WIN32)
+#include <Windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "m_misc.h"
 #include "w_file.h"
 #include "z_zone.h"
 
+//
+// W_MapFile
+// Map the whole of the file into memory so lumps can be used where they are rather than
+// copied out of it. The mapping is copy-on-write so anything that changes a lump changes
+// only its own copy of it. If the file can't be mapped, lumps are read from it instead.
+//
+static void W_MapFile(wadfile_t *wad)
+{
+#if defined(_WIN32)
+    HANDLE          handle = (HANDLE)_get_osfhandle(_fileno(wad->fstream));
+    LARGE_INTEGER   size;
+
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size) || !size.QuadPart
+        || (uint64_t)size.QuadPart > SIZE_MAX)
+        return;
+
+    if (!(wad->mapping = CreateFileMapping(handle, NULL, PAGE_WRITECOPY, 0, 0, NULL)))
+        return;
+
+    if (!(wad->mapped = MapViewOfFile(wad->mapping, FILE_MAP_COPY, 0, 0, 0)))
+    {
+        CloseHandle(wad->mapping);
+        wad->mapping = NULL;
+        return;
+    }
+
+    wad->length = (size_t)size.QuadPart;
+#else
+    struct stat buf;
+    void        *mapped;
+
+    if (fstat(fileno(wad->fstream), &buf) || buf.st_size <= 0 || (uint64_t)buf.st_size > SIZE_MAX)
+        return;
+
+    if ((mapped = mmap(NULL, (size_t)buf.st_size, (PROT_READ | PROT_WRITE), MAP_PRIVATE,
+        fileno(wad->fstream), 0)) == MAP_FAILED)
+        return;
+
+    wad->mapped = mapped;
+    wad->length = (size_t)buf.st_size;
+#endif
+}
+
+static void W_UnmapFile(wadfile_t *wad)
+{
+    if (!wad->mapped)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(wad->mapped);
+    CloseHandle(wad->mapping);
+    wad->mapping = NULL;
+#else
+    munmap(wad->mapped, wad->length);
+#endif
+
+    wad->mapped = NULL;
+    wad->length = 0;
+}
+
 wadfile_t *W_OpenFile(char *path)
 {
     wadfile_t   *result;
@@ -49,22 +117,39 @@ wadfile_t *W_OpenFile(char *path)
         return NULL;
 
     // Create a new wad_file_t to hold the file handle.
-    result = Z_Malloc(sizeof(wadfile_t), PU_STATIC, NULL);
+    result = Z_Calloc(1, sizeof(wadfile_t), PU_STATIC, NULL);
     result->fstream = fstream;
 
+    W_MapFile(result);
+
     return result;
 }
 
 void W_CloseFile(wadfile_t *wad)
 {
+    W_UnmapFile(wad);
     fclose(wad->fstream);
     Z_Free(wad);
 }
 
+void *W_MappedData(wadfile_t *wad, unsigned int offset, size_t length)
+{
+    return (wad->mapped && offset <= wad->length && length <= wad->length - offset ? wad->mapped + offset : NULL);
+}
+
 // Read data from the specified position in the file into the
 // provided buffer. Returns the number of bytes read.
 size_t W_Read(wadfile_t *wad, unsigned int offset, void *buffer, size_t buffer_len)
 {
+    void    *data = W_MappedData(wad, offset, buffer_len);
+
+    // Copy straight out of the file if it's mapped into memory.
+    if (data)
+    {
+        memcpy(buffer, data, buffer_len);
+        return buffer_len;
+    }
+
     // Jump to the specified position in the file.
     fseek(wad->fstream, offset, SEEK_SET);
 
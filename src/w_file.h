@@ -55,6 +55,13 @@ struct wadfile_s
     dboolean    freedoom;
     char        path[MAX_PATH];
     int         type;
+
+    // the whole file mapped into memory, or NULL if it couldn't be
+    byte        *mapped;
+    size_t      length;
+#if defined(_WIN32)
+    void        *mapping;
+#endif
 };
 
 // Open the specified file. Returns a pointer to a new wadfile_t
@@ -69,6 +76,10 @@ void W_CloseFile(wadfile_t *wad);
 // Returns the number of bytes read.
 size_t W_Read(wadfile_t *wad, unsigned int offset, void *buffer, size_t buffer_len);
 
+// Returns a pointer to the data at the specified offset from the start
+// of the file if it is mapped into memory, or NULL if it isn't.
+void *W_MappedData(wadfile_t *wad, unsigned int offset, size_t length);
+
 dboolean M_WriteFile(char const *name, const void *source, size_t length);
 
 #endif
@@ -646,17 +646,49 @@ void W_ReadLump(int lump, void *dest)
         I_Error("W_ReadLump: only read %zd of %i on lump %i", c, l->size, lump);
 }
 
+//
+// W_LumpMappedData
+// Returns a pointer to the lump straight from the WAD file it is in if that file is mapped
+// into memory, or NULL if it isn't. Lumps aren't always 4-byte aligned in WAD files, and as
+// they are cast to structures, those that aren't are also left to be read into the zone.
+//
+void *W_LumpMappedData(int lumpnum)
+{
+    const lumpinfo_t    *lump = lumpinfo[lumpnum];
+
+    if (!lump->size || (lump->position & 3))
+        return NULL;
+
+    return W_MappedData(lump->wadfile, lump->position, lump->size);
+}
+
+//
+// W_CacheLumpNum
+// Returns a pointer to the lump straight from the WAD file it is in if that file is mapped
+// into memory, otherwise reads it into a block of memory that can be purged once released.
+//
 void *W_CacheLumpNum(int lumpnum)
 {
     lumpinfo_t  *lump = lumpinfo[lumpnum];
 
     if (!lump->cache)
-        W_ReadLump(lumpnum, Z_Malloc(lump->size, PU_CACHE, &lump->cache));
+    {
+        void    *data = W_LumpMappedData(lumpnum);
+
+        if (data)
+            lump->cache = data;
+        else
+            W_ReadLump(lumpnum, Z_Malloc(lump->size, PU_CACHE, &lump->cache));
+    }
 
     return lump->cache;
 }
 
 void W_ReleaseLumpNum(int lumpnum)
 {
-    Z_ChangeTag(lumpinfo[lumpnum]->cache, PU_CACHE);
+    lumpinfo_t  *lump = lumpinfo[lumpnum];
+
+    // lumps in mapped WAD files aren't in the zone
+    if (!W_LumpMappedData(lumpnum))
+        Z_ChangeTag(lump->cache, PU_CACHE);
 }
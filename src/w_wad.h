@@ -97,6 +97,7 @@ int W_CheckMultipleLumps(const char *name);
 int W_LumpLength(int lump);
 void W_ReadLump(int lump, void *dest);
 
+void *W_LumpMappedData(int lumpnum);
 void *W_CacheLumpNum(int lumpnum);
 
 #define W_CacheLumpName(name)       W_CacheLumpNum(W_GetNumForName(name))
@@ -1209,4 +1209,6 @@ void WI_Start(wbstartstruct_t *wbstartstruct)
     WI_LoadData();
 
     WI_InitStats();
+
+    S_PrefetchMapMusic(wbstartstruct->epsd + 1, wbstartstruct->next + 1);
 }
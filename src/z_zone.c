@@ -42,6 +42,16 @@
 // Minimum chunk size at which blocks are allocated
 #define CHUNK_SIZE  32
 
+// Size of each chunk of memory that an arena allocates blocks from
+#define ARENA_SIZE  (1024 * 1024)
+
+// Largest block that is kept on a free list for its size once freed
+#define SLAB_MAX    1024
+#define NUMSLABS    (SLAB_MAX / CHUNK_SIZE)
+
+// Tags whose blocks are allocated from an arena rather than by malloc()
+#define ISARENATAG(tag) ((tag) == PU_LEVEL || (tag) == PU_LEVSPEC)
+
 typedef struct memblock_s
 {
     struct memblock_s   *next;
@@ -49,15 +59,178 @@ typedef struct memblock_s
     size_t              size;
     void                **user;
     unsigned char       tag;
+    unsigned char       arena;                          // tag of arena block is in, or PU_FREE
 } memblock_t;
 
+typedef struct arenachunk_s
+{
+    struct arenachunk_s *next;
+    size_t              size;
+    size_t              used;
+} arenachunk_t;
+
+//
+// Arenas
+// Blocks with a tag that only lasts as long as the current level are bumped off the end
+// of large chunks of memory, which are all simply reset at once when the level ends rather
+// than each block being freed. Blocks freed before then are put on a free list for their
+// size (a slab) so blocks such as thinkers that are constantly spawned and removed during
+// a level reuse the same memory.
+//
+typedef struct
+{
+    arenachunk_t        *chunks;
+    arenachunk_t        *current;
+    int                 live;                           // number of blocks still allocated
+    memblock_t          *slabs[NUMSLABS];
+} arena_t;
+
 // size of block header
 // cph - base on sizeof(memblock_t), which can be larger than CHUNK_SIZE on
 // 64bit architectures
 static const size_t headersize = (sizeof(memblock_t) + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
 
+static const size_t chunkheadersize = (sizeof(arenachunk_t) + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1);
+
 static memblock_t   *blockbytag[PU_MAX];
 
+static arena_t      arenas[PU_MAX];
+
+static int          blockcount[PU_MAX];
+static size_t       blockbytes[PU_MAX];
+
+static void *Z_SystemMalloc(size_t size)
+{
+    void    *ptr;
+
+    while (!(ptr = malloc(size)))
+    {
+        if (!blockbytag[PU_CACHE])
+            I_Error("Z_Malloc: Failure trying to allocate %lu bytes", (unsigned long)size);
+
+        Z_FreeTags(PU_CACHE, PU_CACHE);
+    }
+
+    return ptr;
+}
+
+static memblock_t *Z_ArenaMalloc(arena_t *arena, size_t size)
+{
+    arenachunk_t    *chunk;
+    arenachunk_t    *last = NULL;
+    memblock_t      *block;
+
+    // reuse a block of the same size that has already been freed
+    if (size <= SLAB_MAX && (block = arena->slabs[size / CHUNK_SIZE - 1]))
+    {
+        arena->slabs[size / CHUNK_SIZE - 1] = block->next;
+        return block;
+    }
+
+    size += headersize;
+
+    for (chunk = arena->current; chunk; chunk = chunk->next)
+    {
+        if (chunk->size - chunk->used >= size)
+            break;
+
+        last = chunk;
+    }
+
+    if (!chunk)
+    {
+        const size_t    chunksize = (size > ARENA_SIZE ? size : ARENA_SIZE);
+
+        chunk = Z_SystemMalloc(chunkheadersize + chunksize);
+        chunk->next = NULL;
+        chunk->size = chunksize;
+        chunk->used = 0;
+
+        if (last)
+            last->next = chunk;
+        else
+            arena->chunks = chunk;
+    }
+
+    arena->current = chunk;
+    block = (memblock_t *)((char *)chunk + chunkheadersize + chunk->used);
+    chunk->used += size;
+
+    return block;
+}
+
+static void Z_ResetArena(arena_t *arena)
+{
+    arenachunk_t    **link = &arena->chunks;
+
+    while (*link)
+    {
+        arenachunk_t    *chunk = *link;
+
+        // only keep chunks of the usual size around for the next level
+        if (chunk->size > ARENA_SIZE)
+        {
+            *link = chunk->next;
+            free(chunk);
+        }
+        else
+        {
+            chunk->used = 0;
+            link = &chunk->next;
+        }
+    }
+
+    arena->current = arena->chunks;
+    memset(arena->slabs, 0, sizeof(arena->slabs));
+}
+
+static void Z_ArenaFree(arena_t *arena, memblock_t *block)
+{
+    if (!--arena->live)
+        Z_ResetArena(arena);
+    else if (block->size <= SLAB_MAX)
+    {
+        const int   slab = (int)(block->size / CHUNK_SIZE) - 1;
+
+        block->next = arena->slabs[slab];
+        arena->slabs[slab] = block;
+    }
+}
+
+static void Z_LinkBlock(memblock_t *block, int tag)
+{
+    if (!blockbytag[tag])
+    {
+        blockbytag[tag] = block;
+        block->next = block->prev = block;
+    }
+    else
+    {
+        blockbytag[tag]->prev->next = block;
+        block->prev = blockbytag[tag]->prev;
+        block->next = blockbytag[tag];
+        blockbytag[tag]->prev = block;
+    }
+
+    block->tag = tag;
+    blockcount[tag]++;
+    blockbytes[tag] += block->size;
+}
+
+static void Z_UnlinkBlock(memblock_t *block)
+{
+    if (block == block->next)
+        blockbytag[block->tag] = NULL;
+    else if (blockbytag[block->tag] == block)
+        blockbytag[block->tag] = block->next;
+
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+
+    blockcount[block->tag]--;
+    blockbytes[block->tag] -= block->size;
+}
+
 //
 // Z_Malloc
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
@@ -72,38 +245,28 @@ static memblock_t   *blockbytag[PU_MAX];
 //
 void *Z_Malloc(size_t size, int tag, void **user)
 {
-    memblock_t  *block = NULL;
+    memblock_t  *block;
 
     if (!size)
         return (user ? (*user = NULL) : NULL);          // malloc(0) returns NULL
 
     size = (size + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1); // round to chunk size
 
-    while (!(block = malloc(size + headersize)))
+    if (ISARENATAG(tag))
     {
-        if (!blockbytag[PU_CACHE])
-            I_Error("Z_Malloc: Failure trying to allocate %lu bytes", (unsigned long)size);
-
-        Z_FreeTags(PU_CACHE, PU_CACHE);
-    }
-
-    if (!blockbytag[tag])
-    {
-        blockbytag[tag] = block;
-        block->next = block->prev = block;
+        block = Z_ArenaMalloc(&arenas[tag], size);
+        block->arena = tag;
+        arenas[tag].live++;
     }
     else
     {
-        blockbytag[tag]->prev->next = block;
-        block->prev = blockbytag[tag]->prev;
-        block->next = blockbytag[tag];
-        blockbytag[tag]->prev = block;
+        block = Z_SystemMalloc(size + headersize);
+        block->arena = PU_FREE;
     }
 
     block->size = size;
-
-    block->tag = tag;                                   // tag
     block->user = user;                                 // user
+    Z_LinkBlock(block, tag);                            // tag
     block = (memblock_t *)((char *)block + headersize);
 
     if (user)                                           // if there is a user
@@ -124,15 +287,12 @@ void Z_Free(void *ptr)
     if (block->user)                                    // Nullify user if one exists
         *block->user = NULL;
 
-    if (block == block->next)
-        blockbytag[block->tag] = NULL;
-    else if (blockbytag[block->tag] == block)
-        blockbytag[block->tag] = block->next;
-
-    block->prev->next = block->next;
-    block->next->prev = block->prev;
+    Z_UnlinkBlock(block);
 
-    free(block);
+    if (block->arena)
+        Z_ArenaFree(&arenas[block->arena], block);
+    else
+        free(block);
 }
 
 void Z_FreeTags(int lowtag, int hightag)
@@ -153,6 +313,39 @@ void Z_FreeTags(int lowtag, int hightag)
 
         end_block = block->prev;
 
+        if (ISARENATAG(lowtag))
+        {
+            // Rather than free each block in an arena, just forget about them all
+            // and reset the arena once none of its blocks are left.
+            while (true)
+            {
+                memblock_t  *next = block->next;
+
+                if (block->user)
+                    *block->user = NULL;
+
+                if (block->arena)
+                    arenas[block->arena].live--;
+                else
+                    free(block);
+
+                if (block == end_block)
+                    break;
+
+                block = next;
+            }
+
+            blockbytag[lowtag] = NULL;
+            blockcount[lowtag] = 0;
+            blockbytes[lowtag] = 0;
+
+            for (int i = PU_FREE + 1; i < PU_MAX; i++)
+                if (ISARENATAG(i) && !arenas[i].live)
+                    Z_ResetArena(&arenas[i]);
+
+            continue;
+        }
+
         while (true)
         {
             memblock_t  *next = block->next;
@@ -180,26 +373,21 @@ void Z_ChangeTag(void *ptr, int tag)
     if (tag == block->tag)
         return;
 
-    if (block == block->next)
-        blockbytag[block->tag] = NULL;
-    else if (blockbytag[block->tag] == block)
-        blockbytag[block->tag] = block->next;
-
-    block->prev->next = block->next;
-    block->next->prev = block->prev;
+    Z_UnlinkBlock(block);
+    Z_LinkBlock(block, tag);
+}
 
-    if (!blockbytag[tag])
-    {
-        blockbytag[tag] = block;
-        block->next = block->prev = block;
-    }
-    else
-    {
-        blockbytag[tag]->prev->next = block;
-        block->prev = blockbytag[tag]->prev;
-        block->next = blockbytag[tag];
-        blockbytag[tag]->prev = block;
-    }
+//
+// Z_GetTagStats
+// Returns the number of blocks allocated with the given tag, the number of bytes in them,
+// and the number of bytes reserved by the tag's arena if it has one.
+//
+void Z_GetTagStats(int tag, int *count, size_t *bytes, size_t *reserved)
+{
+    *count = blockcount[tag];
+    *bytes = blockbytes[tag];
+    *reserved = 0;
 
-    block->tag = tag;
+    for (arenachunk_t *chunk = arenas[tag].chunks; chunk; chunk = chunk->next)
+        *reserved += chunkheadersize + chunk->size;
 }
@@ -65,5 +65,6 @@ void *Z_Calloc(size_t n1, size_t n2, int tag, void **user);
 void Z_Free(void *ptr);
 void Z_FreeTags(int lowtag, int hightag);
 void Z_ChangeTag(void *ptr, int tag);
+void Z_GetTagStats(int tag, int *count, size_t *bytes, size_t *reserved);
 
 #endif